@@ -1,17 +1,50 @@
 #include "tm4c123gh6pm.h"
 #include <inttypes.h>
 #include <stdlib.h>
+#include "ADC/adc.h"
+#include "GPTM/GPTM.h"
+#include "UDMA/udma.h"
+
+/* uDMA channel 17, encoding 0 is ADC0 SS3, p.587 */
+#define ADC0_SS3_DMA_CHANNEL 17
+
+/* Interrupt number of sequencer 0 of each module, table 2-9 p.104 */
+static const int adcIrq[2] = { 14, 48 };
+
+/* Completion callbacks for conversions started with a callback */
+static void (*volatile adcDone[2][4])(uint32_t);
+
+/* Handlers attached with ADC_attachHandler() */
+static void (*adcHandlers[2][4])(void);
+
+/* Digital comparator callbacks given to ADC_comparators() */
+static void (*adcEvents[2])(int);
+
+/* 0 for ADC0, 1 for ADC1. Indexes the tables above and RCGCADC */
+static int ADC_index(adcModule *adc) {
+
+    return adc == ADC1_MODULE;
+}
 
 /*
- * Initialize the Analog to Digital Converter 0 with sample interrupt enable,
- * end of sequence, and sample sequencer 3. Differential input and temperature are off.
- * Interrupts are off.
+ * Initialize a sample sequencer of either ADC module to convert a list of
+ * channels, one per step, on every trigger. The interrupt flag is raised on
+ * the last step only. Interrupts are off.
+ *
+ * param adc
+ *          ADC0_MODULE or ADC1_MODULE
+ *
+ * param ss
+ *          The sample sequencer, 0 - 3
  *
  * param samplingRate
  *          0x01 - 125ksps
  *          0x03 - 250ksps
  *          0x05 - 500ksps
  *          0x07 - 1Msps
+ *          0x00 - leave the rate and sequencer priorities as they are. Both
+ *                 are shared by the whole module, so use this to add a
+ *                 sequencer to a module that is already running.
  *
  * param trigger
  *          0x00 - Processor (Default)
@@ -21,51 +54,422 @@
  *          0x05 - Timer
  *          0x0F - Always (continuously sample)
  *
- * param sampleSelect
- *          0x01 - 0x09 corresponds to AIN0 - AIN9
+ * param channels
+ *          AIN numbers, 0 - 11, in the order they are to be sampled. The same
+ *          channel may appear more than once. ADC_CHANNEL_TEMP samples the
+ *          internal temperature sensor instead.
  *          See table 21-5 on p.1135 of data sheet
+ *
+ * param count
+ *          Number of entries in channels, 1 up to the FIFO depth of the
+ *          sequencer: 8 for SS0, 4 for SS1 and SS2 and 1 for SS3.
  */
-void init_adc0(unsigned int samplingRate, unsigned int trigger, unsigned int sampleSelect) {
+void ADC_init(adcModule *adc, int ss, unsigned int samplingRate, unsigned int trigger,
+              const unsigned int *channels, int count) {
 
     /* See page 463 of Valvano text for init procedure */
 
     volatile unsigned long delay_clk;
-
-    SYSCTL_RCGCADC_R |= 0x01; //p.322 - to enable clock for ADC module 0
+    int module = ADC_index(adc);
+    unsigned long mux = 0;
+    unsigned long ctl = 0;
+    int i;
+
+    if(ss < 0 || ss > 3 || count < 1 || count > ADC_SS_DEPTH(ss))
+        exit(EXIT_FAILURE);
+    if(samplingRate != 0x00 && samplingRate != 0x01 && samplingRate != 0x03 &&
+       samplingRate != 0x05 && samplingRate != 0x07)
+        exit(EXIT_FAILURE);
+    if(trigger != 0x00 && trigger != 0x01 && trigger != 0x02 &&
+       trigger != 0x04 && trigger != 0x05 && trigger != 0x0F)
+        exit(EXIT_FAILURE);
+
+    SYSCTL_RCGCADC_R |= 1UL << module; //p.322 - to enable clock for the ADC module
     delay_clk = SYSCTL_RCGCADC_R; //dummy operation for clock to settle
     delay_clk = SYSCTL_RCGCADC_R; //dummy operation for clock to settle
 
-    ADC0_PC_R |= samplingRate;  //p.840 - to select sampling rate
-    ADC0_SSPRI_R |= 0x0123;   //p.791 - to select SS priority. ADC3 has the highest priority
-                      //The priority doesn't matter since we are only using one ADC. But set
-                      // anyway since they all must have a different priority.
-
-    ADC0_ACTSS_R &= ~0x0008; //p.774 - disable ADC during setup
-
-    //p.785 - set trigger mode
-    switch(trigger) {
-
-        case 0x00:  ADC0_EMUX_R &= ~0xF000;
-                    break;
-        case 0x01:  ADC0_EMUX_R |= 0x1000;
-                    break;
-        case 0x02:  ADC0_EMUX_R |= 0x2000;
-                    break;
-        case 0x04:  ADC0_EMUX_R |= 0x4000;
-                    break;
-        case 0x05:  ADC0_EMUX_R |= 0x5000;
-                    break;
-        case 0x0F:  ADC0_EMUX_R |= 0xF000;
-                    break;
-        default:    exit(EXIT_FAILURE);
+    if(samplingRate) {
+        adc->PC = (adc->PC & ~0x0F) | samplingRate;  //p.840 - to select sampling rate
+        adc->SSPRI = 0x0123;   //p.791 - SS3 highest, SS0 lowest. They must all differ.
+    }
+
+    adc->ACTSS &= ~(1UL << ss); //p.774 - disable the sequencer during setup
+
+    adc->EMUX = (adc->EMUX & ~(0xFUL << (4 * ss))) | (trigger << (4 * ss)); //p.785
+
+    for(i = 0; i < count; i++) {
+        if(channels[i] == ADC_CHANNEL_TEMP)
+            ctl |= 0x8UL << (4 * i); //TSn, the step reads the temperature sensor
+        else if(channels[i] > 11)
+            exit(EXIT_FAILURE);
+        else
+            mux |= (unsigned long)channels[i] << (4 * i); //one nibble per step
     }
-    ADC0_SSMUX3_R = (ADC0_SSMUX3_R & 0xFFFFFFF0) + sampleSelect; //Clear SS3 field
-    //ADC0_SSMUX3_R |= sampleSelect;
-    ADC0_SSCTL3_R |= 0b0110; //p.826 - to configure sequencer control
-    ADC0_IM_R &= ~0x0008; //disable SS3 interrupts
+    adc->SS[ss].SSMUX = mux; //p.801
+    adc->SS[ss].SSCTL = ctl | (0x6UL << (4 * (count - 1))); //p.802 - END and IE on the last step only
+    adc->IM &= ~(1UL << ss); //disable the sequencer interrupt
 
     /* re-initiate after setup */
-    ADC0_ACTSS_R |= 0x0008; //p.774 -
+    adc->ACTSS |= 1UL << ss; //p.774
+}
+
+/*
+ * Turn on the hardware averager of a module, p.811. Every result in every
+ * sequencer of the module becomes the mean of factor conversions, so the
+ * sample rate drops by the same factor at no CPU cost. Follow with a
+ * cicFilter (ADC/cic.h) for more bits than the averager alone gives.
+ *
+ * param factor
+ *          1 (off), 2, 4, 8, 16, 32 or 64
+ */
+void ADC_oversample(adcModule *adc, int factor) {
+
+    uint32_t sac = 0;
+
+    if(factor < 1 || factor > 64 || (factor & (factor - 1)))
+        exit(EXIT_FAILURE);
+
+    while((1 << sac) < factor)
+        sac++;
+    adc->SAC = sac;
+}
+
+/*
+ * Unmask the interrupt of a sequencer without touching its priority
+ */
+static void ADC_unmask(adcModule *adc, int ss) {
+
+    int irq = adcIrq[ADC_index(adc)] + ss;
+
+    adc->ISC = 1UL << ss; //clear anything left over
+    adc->IM |= 1UL << ss;
+    (&NVIC_EN0_R)[irq / 32] = 1UL << (irq % 32);
+}
+
+/*
+ * Set the priority of a sequencer's vector and enable it in the NVIC
+ */
+static void ADC_nvic(adcModule *adc, int ss, int pri) {
+
+    int irq = adcIrq[ADC_index(adc)] + ss;
+    volatile unsigned long *nvicPri = &NVIC_PRI0_R + (irq / 4);
+    int shift = (irq % 4) * 8 + 5; // 4n+m, bits 7:5 of byte m
+
+    if(pri < 0 || pri > 7)
+        exit(EXIT_FAILURE);
+
+    *nvicPri = (*nvicPri & ~(0x7UL << shift)) | ((unsigned long)pri << shift);
+    (&NVIC_EN0_R)[irq / 32] = 1UL << (irq % 32);
+}
+
+/*
+ * Enable the interrupt of a sample sequencer in the ADC and the NVIC. The
+ * digital comparator interrupts of a sequencer share its vector.
+ *
+ * param pri
+ *          The priority of the interrupt, 0 to 7.
+ */
+void ADC_enableInterrupt(adcModule *adc, int ss, int pri) {
+
+    ADC_nvic(adc, ss, pri);
+    ADC_unmask(adc, ss);
+}
+
+/*
+ * Start a conversion on a sample sequencer and return straight away.
+ *
+ * param done
+ *          Called from the sequencer's handler once for every result, in
+ *          step order, when the sequence is complete. Use 0 to collect the
+ *          results with ADC_pollSequence() instead.
+ */
+void ADC_startSequence(adcModule *adc, int ss, void (*done)(uint32_t)) {
+
+    int module = ADC_index(adc);
+
+    adcDone[module][ss] = done;
+    if(done)
+        ADC_unmask(adc, ss);
+    else if(!adcHandlers[module][ss])
+        adc->IM &= ~(1UL << ss); //leave the results for ADC_pollSequence()
+
+    ADC_start(adc, ss);
+}
+
+/*
+ * Collect the results of a conversion started by ADC_startSequence(adc, ss, 0)
+ *
+ * param results
+ *          Room for max results.
+ *
+ * param max
+ *          The most results to store. See ADC_readSequence().
+ *
+ * returns the number of results stored, or -1 if the conversion is still
+ * running.
+ */
+int ADC_pollSequence(adcModule *adc, int ss, uint32_t *results, int max) {
+
+    if(!ADC_done(adc, ss))
+        return -1;
+
+    return ADC_readSequence(adc, ss, results, max);
+}
+
+/*
+ * Drain the FIFO of a sequencer and clear its completion flag. The FIFO is
+ * always emptied, so results beyond max are read and thrown away rather
+ * than left to be mistaken for the next conversion.
+ *
+ * param results
+ *          Room for max results.
+ *
+ * param max
+ *          The most results to store.
+ *
+ * returns the number of results stored.
+ */
+int ADC_readSequence(adcModule *adc, int ss, uint32_t *results, int max) {
+
+    int n = 0;
+    uint32_t result;
+
+    while(!(adc->SS[ss].SSFSTAT & 0x100)) { //p.804 - EMPTY
+        result = ADC_readFifo(adc, ss);
+        if(n < max)
+            results[n++] = result;
+    }
+
+    adc->ISC = 1UL << ss; //Clear the bit by writing to it.
+
+    return n;
+}
+
+/*
+ * Call handler from the interrupt of a sequencer whenever no conversion
+ * callback is waiting, e.g. for acquisition, which reads the FIFO itself.
+ */
+void ADC_attachHandler(adcModule *adc, int ss, void (*handler)(void)) {
+
+    adcHandlers[ADC_index(adc)][ss] = handler;
+}
+
+/*
+ * The handler attached to a sequencer, e.g. to wrap it in a measurement
+ */
+void (*ADC_handlerOf(adcModule *adc, int ss))(void) {
+
+    return adcHandlers[ADC_index(adc)][ss];
+}
+
+/*
+ * Digital comparator interrupts of a module. DCISC says which comparators
+ * fired. Each is cleared and then reported.
+ */
+static void ADC_comparatorEvents(int module, adcModule *adc) {
+
+    uint32_t fired = adc->DCISC & 0xFF; //p.821
+    void (*event)(int) = adcEvents[module];
+    int dc;
+
+    adc->DCISC = fired; //write 1 to clear
+
+    for(dc = 0; fired; dc++, fired >>= 1) {
+        if((fired & 0x01) && event)
+            event(dc);
+    }
+}
+
+/*
+ * Shared body of the eight sequencer interrupt handlers
+ */
+static void ADC_handler(int module, int ss) {
+
+    adcModule *adc = module ? ADC1_MODULE : ADC0_MODULE;
+    uint32_t status = adc->ISC; //p.782 - reads as the masked status
+    void (*done)(uint32_t) = adcDone[module][ss];
+
+    if(status & (0x10000UL << ss)) {
+        ADC_comparatorEvents(module, adc);
+        adc->ISC = 0x10000UL << ss; //DCINSSn, once DCISC is clear
+    }
+
+    if(!(status & (1UL << ss)))
+        return;
+
+    adc->ISC = 1UL << ss; //acknowledge
+
+    if(done) {
+        adcDone[module][ss] = 0; //the callback may start the next conversion
+        while(!(adc->SS[ss].SSFSTAT & 0x100))
+            done(ADC_readFifo(adc, ss));
+        return;
+    }
+
+    if(adcHandlers[module][ss])
+        adcHandlers[module][ss]();
+}
+
+/*
+ * Set up digital comparators from a table, so out of range samples raise an
+ * interrupt and samples that stay in range never reach the CPU. Every entry
+ * is written from scratch: the comparator's old thresholds, state and mode
+ * are cleared before the new ones go in, and the chosen step of the
+ * sequencer is sent to that comparator instead of the FIFO (p.828, p.829).
+ * The DC interrupt of every sequencer in the table is enabled, so run
+ * ADC_init() on those sequencers first.
+ *
+ * param table
+ *          One entry per comparator to set up.
+ *
+ * param count
+ *          Number of entries in table, 1 - 8.
+ *
+ * param event
+ *          Called from the sequencer's handler with the number of each
+ *          comparator that fired. May be 0 to poll ADC_comparatorState()
+ *          instead.
+ *
+ * param pri
+ *          The priority of the sequencer interrupts, 0 to 7.
+ */
+void ADC_comparators(adcModule *adc, const adcComparator *table, int count,
+                     void (*event)(int), int pri) {
+
+    int module = ADC_index(adc);
+    uint32_t sequencers = 0;
+    const adcComparator *dc;
+    int shift;
+    int ss;
+    int i;
+
+    if(count < 1 || count > 8)
+        exit(EXIT_FAILURE);
+
+    adcEvents[module] = event;
+
+    for(i = 0; i < count; i++) {
+        dc = &table[i];
+        if(dc->comparator < 0 || dc->comparator > 7 ||
+           dc->sequencer < 0 || dc->sequencer > 3 ||
+           dc->step < 0 || dc->step >= ADC_SS_DEPTH(dc->sequencer))
+            exit(EXIT_FAILURE);
+        if(dc->condition != ADC_DC_LOW_BAND && dc->condition != ADC_DC_MID_BAND &&
+           dc->condition != ADC_DC_HIGH_BAND)
+            exit(EXIT_FAILURE);
+        /* Hysteresis needs an opposite region, which the mid band has not */
+        if(dc->mode < 0 || dc->mode > 3 ||
+           (dc->mode >= ADC_DC_HYSTERESIS_ALWAYS && dc->condition == ADC_DC_MID_BAND))
+            exit(EXIT_FAILURE);
+        if(dc->comp0 > 0xFFF || dc->comp1 > 0xFFF || dc->comp0 > dc->comp1)
+            exit(EXIT_FAILURE);
+
+        adc->DCCTL[dc->comparator] = 0; //p.836
+        adc->DCRIC = 1UL << dc->comparator; //p.830 - reset the comparator state
+        adc->DCCMP[dc->comparator] = dc->comp0 | ((uint32_t)dc->comp1 << 16); //p.838
+        adc->DCCTL[dc->comparator] = 0x10 | (dc->condition << 2) | dc->mode; //CIE, CIC, CIM
+
+        shift = 4 * dc->step;
+        adc->SS[dc->sequencer].SSDC = (adc->SS[dc->sequencer].SSDC & ~(0xFUL << shift)) |
+                                      ((uint32_t)dc->comparator << shift);
+        adc->SS[dc->sequencer].SSOP |= 0x1UL << shift; //DCONn, the step goes to the comparator
+        sequencers |= 1UL << dc->sequencer;
+    }
+
+    adc->DCISC = 0xFF; //nothing left over from before
+    for(ss = 0; ss < 4; ss++) {
+        if(sequencers & (1UL << ss)) {
+            adc->ISC = 0x10000UL << ss;
+            adc->IM |= 0x10000UL << ss; //p.777 - DCONSSn
+            ADC_nvic(adc, ss, pri);
+        }
+    }
+}
+
+/*
+ * Stop a comparator and hand its steps back to the FIFOs
+ */
+void ADC_comparatorOff(adcModule *adc, int comparator) {
+
+    int ss, step;
+
+    adc->DCCTL[comparator] = 0;
+    adc->DCRIC = 1UL << comparator;
+
+    for(ss = 0; ss < 4; ss++) {
+        for(step = 0; step < ADC_SS_DEPTH(ss); step++) {
+            if((adc->SS[ss].SSOP & (0x1UL << (4 * step))) &&
+               ((adc->SS[ss].SSDC >> (4 * step)) & 0xF) == (uint32_t)comparator)
+                adc->SS[ss].SSOP &= ~(0x1UL << (4 * step));
+        }
+    }
+}
+
+/*
+ * Comparators that have fired but not been cleared, one bit each. For use
+ * without an event callback. Clears the bits it returns.
+ */
+uint32_t ADC_comparatorState(adcModule *adc) {
+
+    uint32_t fired = adc->DCISC & 0xFF;
+
+    adc->DCISC = fired;
+    return fired;
+}
+
+void ADC0Seq0_Handler(void) { ADC_handler(0, 0); }
+void ADC0Seq1_Handler(void) { ADC_handler(0, 1); }
+void ADC0Seq2_Handler(void) { ADC_handler(0, 2); }
+void ADC0Seq3_Handler(void) { ADC_handler(0, 3); }
+void ADC1Seq0_Handler(void) { ADC_handler(1, 0); }
+void ADC1Seq1_Handler(void) { ADC_handler(1, 1); }
+void ADC1Seq2_Handler(void) { ADC_handler(1, 2); }
+void ADC1Seq3_Handler(void) { ADC_handler(1, 3); }
+
+/*
+ * Initialize the Analog to Digital Converter 0 with sample interrupt enable,
+ * end of sequence, and sample sequencer 3. Differential input and temperature are off.
+ * Interrupts are off.
+ *
+ * param samplingRate
+ *          As for ADC_init
+ *
+ * param trigger
+ *          As for ADC_init
+ *
+ * param sampleSelect
+ *          0x01 - 0x09 corresponds to AIN0 - AIN9
+ *          See table 21-5 on p.1135 of data sheet
+ */
+void init_adc0(unsigned int samplingRate, unsigned int trigger, unsigned int sampleSelect) {
+
+    ADC_init(ADC0_MODULE, 3, samplingRate, trigger, &sampleSelect, 1);
+}
+
+/*
+ * Start a conversion on ADC0 sample sequencer 3 and return straight away.
+ *
+ * param done
+ *          Called from ADC0Seq3_Handler() with the result when the
+ *          conversion is complete. Use 0 to collect the result with
+ *          ADC0_pollSeq3() instead.
+ */
+void ADC0_startSeq3(void (*done)(uint32_t)) {
+
+    ADC_startSequence(ADC0_MODULE, 3, done);
+}
+
+/*
+ * Collect the result of a conversion started by ADC0_startSeq3(0)
+ *
+ * param result
+ *          Where the 12 bit result is stored.
+ *
+ * returns 0 if the result was stored, -1 if the conversion is still running.
+ */
+int ADC0_pollSeq3(uint32_t *result) {
+
+    return ADC_pollSequence(ADC0_MODULE, 3, result, 1) < 0 ? -1 : 0;
 }
 
 /*
@@ -73,26 +477,374 @@ void init_adc0(unsigned int samplingRate, unsigned int trigger, unsigned int sam
  */
 uint32_t ADC0_InSeq3(void) {
 
-    uint32_t result;
+    return ADC_sample(ADC0_MODULE, 3);
+}
+
+/*
+ * Initialize ADC0 sample sequencer 0 to convert a list of channels, one per
+ * step, on every trigger. SS0 has 8 steps and an 8 deep FIFO, so one trigger
+ * and one wait give a whole vector of results instead of a round trip per
+ * channel through SS3.
+ *
+ * param channels, count
+ *          As for ADC_init, up to 8 channels.
+ */
+void init_adc0_scan(unsigned int samplingRate, unsigned int trigger, const unsigned int *channels, int count) {
+
+    ADC_init(ADC0_MODULE, 0, samplingRate, trigger, channels, count);
+}
+
+/*
+ * Trigger SS0 and read back one result per channel given to init_adc0_scan()
+ *
+ * param results
+ *          Room for as many results as there were channels.
+ *
+ * returns the number of results written.
+ */
+int ADC0_InSeq0(uint32_t *results) {
+
+    int n;
+
+    ADC_startSequence(ADC0_MODULE, 0, 0);
+    while((n = ADC_pollSequence(ADC0_MODULE, 0, results, ADC_SS_DEPTH(0))) < 0);
+
+    return n;
+}
+
+/*
+ * Ping-pong state for init_adc0_acquire(). The handler fills acqActive while
+ * the application works on the other buffer.
+ */
+static uint16_t *acqBufferA;
+static uint16_t *acqBufferB;
+static uint16_t *volatile acqActive;
+static volatile int acqFill;
+static int acqBlockSize;
+static void (*acqBlockDone)(uint16_t *, int);
+
+static volatile unsigned long acqBlocks;
+static volatile unsigned long acqOverruns;
+
+/*
+ * SS3 handler for init_adc0_acquire(). Moves one result per interrupt.
+ */
+static void adc0_acquireSample(void) {
+
+    uint16_t *full;
+
+    acqActive[acqFill++] = ADC_readFifo(ADC0_MODULE, 3);
+    if(acqFill == acqBlockSize) {
+        full = acqActive;
+        acqActive = (full == acqBufferA) ? acqBufferB : acqBufferA;
+        acqFill = 0;
+        acqBlocks++;
+        if(acqBlockDone)
+            acqBlockDone(full, acqBlockSize);
+    }
+}
+
+/*
+ * Sample one channel on ADC0 continuously at a rate set by Timer 1A, into two
+ * buffers used in turn. Sequencer 3 is triggered by the timer, so samples are
+ * evenly spaced no matter what the CPU is doing, and ADC0Seq3_Handler() moves
+ * each result out of the FIFO. When a buffer fills, blockDone gets it and
+ * the next samples go to the other buffer. blockDone runs in the interrupt
+ * and must be finished with the buffer before the other one fills.
+ *
+ * param samplingRate
+ *          As for init_adc0. Must be faster than the timer rate.
+ *
+ * param sampleSelect
+ *          0x01 - 0x09 corresponds to AIN0 - AIN9
+ *          See table 21-5 on p.1135 of data sheet
+ *
+ * param period
+ *          Bus clock cycles between samples, e.g. 800 for 100ksps at 80MHz.
+ *
+ * param bufferA, bufferB
+ *          The two buffers, each blockSize samples long.
+ *
+ * param blockDone
+ *          Called with each full buffer and its length.
+ *
+ * param pri
+ *          The priority of the SS3 interrupt, 0 to 7.
+ */
+void init_adc0_acquire(unsigned int samplingRate, unsigned int sampleSelect, uint32_t period,
+                       uint16_t *bufferA, uint16_t *bufferB, int blockSize,
+                       void (*blockDone)(uint16_t *, int), int pri) {
+
+    if(blockSize < 1)
+        exit(EXIT_FAILURE);
+
+    acqBufferA = bufferA;
+    acqBufferB = bufferB;
+    acqActive = bufferA;
+    acqFill = 0;
+    acqBlockSize = blockSize;
+    acqBlockDone = blockDone;
+    acqBlocks = 0;
+    acqOverruns = 0;
+
+    init_adc0(samplingRate, 0x05, sampleSelect); //SS3, timer trigger
+
+    ADC_attachHandler(ADC0_MODULE, 3, adc0_acquireSample);
+    ADC_enableInterrupt(ADC0_MODULE, 3, pri); //SS3 interrupt on every sample
+
+    init_timer1A_ADCtrigger(period);
+}
+
+/*
+ * Point one half of the SS3 ping-pong transfer at its buffer
+ */
+static void adc0_armDma(int alt) {
+
+    UDMA_setTransfer(ADC0_SS3_DMA_CHANNEL, alt, &ADC0_MODULE->SS[3].SSFIFO, alt ? acqBufferB : acqBufferA,
+                     UDMA_CHCTL_DSTINC_16 | UDMA_CHCTL_DSTSIZE_16 |
+                     UDMA_CHCTL_SRCINC_NONE | UDMA_CHCTL_SRCSIZE_16 |
+                     UDMA_CHCTL_ARBSIZE_1 |
+                     ((uint32_t)(acqBlockSize - 1) << UDMA_CHCTL_XFERSIZE_S) |
+                     UDMA_CHCTL_XFERMODE_PINGPONG);
+}
+
+/*
+ * End of block for init_adc0_acquireDMA(). Whichever half stopped is
+ * re-armed straight away, then handed to the application.
+ */
+static void adc0_dmaBlock(void) {
+
+    int primaryDone = (UDMA_getMode(ADC0_SS3_DMA_CHANNEL, 0) == UDMA_CHCTL_XFERMODE_STOP);
+    int alternateDone = (UDMA_getMode(ADC0_SS3_DMA_CHANNEL, 1) == UDMA_CHCTL_XFERMODE_STOP);
+
+    UDMA_isDone(ADC0_SS3_DMA_CHANNEL);
+
+    if(primaryDone && alternateDone) {
+        /* Both halves filled before we got here, the controller has stopped */
+        acqOverruns++;
+        adc0_armDma(0);
+        adc0_armDma(1);
+        UDMA_enable(ADC0_SS3_DMA_CHANNEL);
+        return;
+    }
+
+    if(primaryDone) {
+        adc0_armDma(0);
+        acqBlocks++;
+        if(acqBlockDone)
+            acqBlockDone(acqBufferA, acqBlockSize);
+    }
+    if(alternateDone) {
+        adc0_armDma(1);
+        acqBlocks++;
+        if(acqBlockDone)
+            acqBlockDone(acqBufferB, acqBlockSize);
+    }
+}
+
+/*
+ * Same as init_adc0_acquire(), but uDMA moves every result from the SS3 FIFO
+ * to RAM, so the CPU does nothing per sample. The primary and alternate
+ * uDMA control structures point at bufferA and bufferB. The controller
+ * switches between them by itself, and the SS3 interrupt only fires at the
+ * end of each block. This keeps up with the full 1Msps.
+ *
+ * param period
+ *          Bus clock cycles between samples, e.g. 80 for 1Msps at 80MHz.
+ *          0 samples as fast as samplingRate allows (always trigger).
+ *
+ * param blockSize
+ *          1 - 1024, the most a single uDMA transfer can move.
+ *
+ * The other parameters are as for init_adc0_acquire(). If blockDone is still
+ * busy with one buffer when the other fills, the controller stops. The
+ * handler then restarts both halves and counts an overrun, see
+ * ADC0_acquireStats().
+ */
+void init_adc0_acquireDMA(unsigned int samplingRate, unsigned int sampleSelect, uint32_t period,
+                          uint16_t *bufferA, uint16_t *bufferB, int blockSize,
+                          void (*blockDone)(uint16_t *, int), int pri) {
+
+    if(blockSize < 1 || blockSize > UDMA_MAX_TRANSFER)
+        exit(EXIT_FAILURE);
+
+    acqBufferA = bufferA;
+    acqBufferB = bufferB;
+    acqBlockSize = blockSize;
+    acqBlockDone = blockDone;
+    acqBlocks = 0;
+    acqOverruns = 0;
+
+    init_adc0(samplingRate, period ? 0x05 : 0x0F, sampleSelect); //SS3
+
+    init_udma();
+    UDMA_assign(ADC0_SS3_DMA_CHANNEL, 0);
+    adc0_armDma(0);
+    adc0_armDma(1);
+    UDMA_enable(ADC0_SS3_DMA_CHANNEL);
+
+    ADC_attachHandler(ADC0_MODULE, 3, adc0_dmaBlock);
+    ADC_enableInterrupt(ADC0_MODULE, 3, pri); //with uDMA, SS3 only interrupts when a transfer completes
+
+    if(period)
+        init_timer1A_ADCtrigger(period);
+}
+
+/*
+ * Stop the acquisition started by init_adc0_acquire() or
+ * init_adc0_acquireDMA(). A partly filled buffer is dropped.
+ */
+void ADC0_stopAcquire(void) {
+
+    stop_timer1A();
+    UDMA_disable(ADC0_SS3_DMA_CHANNEL);
+    ADC0_MODULE->IM &= ~0x08;
+    ADC_attachHandler(ADC0_MODULE, 3, 0);
+    acqBlockDone = 0;
+}
+
+/*
+ * Blocks delivered and blocks lost to overruns since the acquisition was
+ * started. The sustained sample rate is blocks * blockSize over the time
+ * measured by the caller. BENCH_acquire() in DSP/bench.c measures it, and
+ * the CPU time taken by the handler, with the cycle counter.
+ */
+void ADC0_acquireStats(unsigned long *blocks, unsigned long *overruns) {
+
+    *blocks = acqBlocks;
+    *overruns = acqOverruns;
+}
+
+/*
+ * Set up sequencer 3 of both modules for paired sampling, one channel on
+ * each, e.g. voltage on ADC0 and current on ADC1. Both modules run from the
+ * same conversion clock, so when they are triggered together the two
+ * samples are taken on the same clock edge.
+ *
+ * param samplingRate
+ *          As for ADC_init
+ *
+ * param channel0, channel1
+ *          AIN numbers for ADC0 and ADC1, 0 - 11
+ */
+void ADC_syncInit(unsigned int samplingRate, unsigned int channel0, unsigned int channel1) {
+
+    ADC_init(ADC0_MODULE, 3, samplingRate, 0x00, &channel0, 1);
+    ADC_init(ADC1_MODULE, 3, samplingRate, 0x00, &channel1, 1);
+}
 
-    ADC0_PSSI_R |= 0x0008; //p.795 - Begin sampling on sample sequencer 3
+/*
+ * Take one pair of samples set up by ADC_syncInit(). Both sequencers are
+ * armed with SYNCWAIT, then a single GSYNC write starts them together.
+ */
+void ADC_syncSample(adcPair *pair) {
+
+    ADC0_MODULE->PSSI = ADC_PSSI_SYNCWAIT | 0x08; //p.795 - armed, but held
+    ADC1_MODULE->PSSI = ADC_PSSI_SYNCWAIT | 0x08;
+    ADC0_MODULE->PSSI = ADC_PSSI_GSYNC; //starts every module that is held
+
+    while(!ADC_done(ADC0_MODULE, 3) || !ADC_done(ADC1_MODULE, 3));
+
+    pair->adc0 = ADC_readFifo(ADC0_MODULE, 3);
+    pair->adc1 = ADC_readFifo(ADC1_MODULE, 3);
+    ADC0_MODULE->ISC = 0x08;
+    ADC1_MODULE->ISC = 0x08;
+}
+
+/* Ping-pong state for ADC_syncAcquire() */
+static adcPair *syncBufferA;
+static adcPair *syncBufferB;
+static adcPair *volatile syncActive;
+static volatile int syncFill;
+static int syncBlockSize;
+static void (*syncBlockDone)(adcPair *, int);
+
+/*
+ * ADC1 SS3 handler for ADC_syncAcquire(). ADC0 finishes on the same clock,
+ * so its result is already waiting.
+ */
+static void adc_syncPair(void) {
+
+    adcPair *full;
+
+    while(!ADC_done(ADC0_MODULE, 3));
+    syncActive[syncFill].adc0 = ADC_readFifo(ADC0_MODULE, 3);
+    syncActive[syncFill].adc1 = ADC_readFifo(ADC1_MODULE, 3);
+    ADC0_MODULE->ISC = 0x08;
+    syncFill++;
+
+    if(syncFill == syncBlockSize) {
+        full = syncActive;
+        syncActive = (full == syncBufferA) ? syncBufferB : syncBufferA;
+        syncFill = 0;
+        if(syncBlockDone)
+            syncBlockDone(full, syncBlockSize);
+    }
+}
 
-    /* Poll the conversion completion bit of SS3 */
-    while((ADC0_RIS_R & 0x08) == 0x00);
+/*
+ * Sample a pair of channels continuously at a rate set by Timer 1A. The
+ * timer's trigger reaches both modules at once, so every pair is taken at
+ * the same instant, and the pairs go into two buffers used in turn as for
+ * init_adc0_acquire(). Uses ADC0 SS3 and Timer 1A, so it cannot run
+ * alongside init_adc0_acquire() or init_adc0_acquireDMA().
+ *
+ * param channel0, channel1
+ *          AIN numbers for ADC0 and ADC1, 0 - 11
+ *
+ * param period
+ *          Bus clock cycles between pairs.
+ *
+ * param bufferA, bufferB
+ *          The two buffers, each blockSize pairs long.
+ *
+ * param blockDone
+ *          Called from the ADC1 SS3 interrupt with each full buffer.
+ *
+ * The other parameters are as for init_adc0_acquire().
+ */
+void ADC_syncAcquire(unsigned int samplingRate, unsigned int channel0, unsigned int channel1,
+                     uint32_t period, adcPair *bufferA, adcPair *bufferB, int blockSize,
+                     void (*blockDone)(adcPair *, int), int pri) {
+
+    if(blockSize < 1)
+        exit(EXIT_FAILURE);
 
-    /* Read FIFO for the value, which is the value obtained by the ADC */
-    result = ADC0_SSFIFO3_R & 0xFFF;
+    syncBufferA = bufferA;
+    syncBufferB = bufferB;
+    syncActive = bufferA;
+    syncFill = 0;
+    syncBlockSize = blockSize;
+    syncBlockDone = blockDone;
 
-    ADC0_ISC_R = 0x0008; //Clear the bit by writing to it.
+    ADC_init(ADC0_MODULE, 3, samplingRate, 0x05, &channel0, 1); //timer trigger
+    ADC_init(ADC1_MODULE, 3, samplingRate, 0x05, &channel1, 1);
 
-    return result;
+    ADC_attachHandler(ADC1_MODULE, 3, adc_syncPair);
+    ADC_enableInterrupt(ADC1_MODULE, 3, pri); //one interrupt per pair
+
+    init_timer1A_ADCtrigger(period);
 }
+
 /*
- * enable interrupts on ADC0. Don't forget to include the handler
- * ADC0Seqn_Handler(), where n is the sequencer being used. An exemplary
+ * Stop ADC_syncAcquire(). A partly filled buffer is dropped.
+ */
+void ADC_stopSyncAcquire(void) {
+
+    stop_timer1A();
+    ADC1_MODULE->IM &= ~0x08;
+    ADC_attachHandler(ADC1_MODULE, 3, 0);
+    syncBlockDone = 0;
+}
+
+/*
+ * enable interrupts on ADC0. Use ADC_attachHandler() to be called from
+ * the sequencer's interrupt. An exemplary
  * use of this might be to interrupt whenever the digital comparator detects
  * a value in a certain range. In this case, you would not want to use SS
- * interrupts.
+ * interrupts. The comparator is set up by ADC_comparators() on the first
+ * step of SS, and its events go to the callback last given to that. Use
+ * ADC_comparators() directly for more than one comparator.
  *
  * param SSI:
  *          Sample Sequencer interrupt. Use 0, 1, 2, or 3 for Sample Sequencer
@@ -160,218 +912,49 @@ uint32_t ADC0_InSeq3(void) {
  */
 void ADC0_interrupt(int SSI, int DCSS, int SS, int DC, int CIE, int CIC, int CIM, int pri, int COMP0, int COMP1) {
 
-    int priority;
+    adcModule *adc = ADC0_MODULE;
+    adcComparator dc;
 
-    /* Disable interrupts during setup */
-    if(SSI >= 0) {
-        switch (SSI) {
+    if(SSI > 3 || DCSS > 3 || DC > 7)
+        exit(EXIT_FAILURE);
 
-               case 0: ADC0_IM_R &= ~0x01;
-                   break;
-
-               case 1: ADC0_IM_R &= ~0x02;
-                   break;
-
-               case 2: ADC0_IM_R &= ~0x04;
-                   break;
-
-               case 3: ADC0_IM_R &= ~0x08;
-                   break;
-
-               default:    exit(EXIT_FAILURE);
-        }
-    }
-
-    /* More disables for setup */
-    if(DCSS >= 0) {
-        switch (DCSS) {
-
-            case 0: ADC0_IM_R &= ~0x00010000;
-                break;
-
-            case 1: ADC0_IM_R &= ~0x00020000;
-                break;
-
-            case 2: ADC0_IM_R &= ~0x00040000;
-                break;
-
-            case 3: ADC0_IM_R &= ~0x00080000;
-                break;
-
-            default:    exit(EXIT_FAILURE);
-        }
-    }
+    /* Disable interrupts during setup */
+    if(SSI >= 0)
+        adc->IM &= ~(1UL << SSI);
 
-    /* Set the desired bits for the desired comparator */
-    /* TODO: Need to do enables on Register 37, Pg. 829. and 828. */
-    /* Note that if a sample is sent to a digital comparator, it is */
-    /* not sent to the respective FIFO */
+    /* A one entry table for the comparator engine, on the first step of SS */
     if(DC >= 0) {
-        switch (DC) {
-
-            case 0: ADC0_DCCTL0_R |= 0x10;
-                    ADC0_DCCTL0_R |= CIM;
-                    ADC0_DCCTL0_R |= (CIC << 2);
-                    ADC0_DCCMP0_R |= COMP0;
-                    ADC0_DCCMP0_R |= (COMP1 << 16);
-                    /* enable the digital comparator on the sample sequencer */
-                    if(0 == SS) {
-                        ADC0_SSOP0_R |= 0b1;
-                        ADC0_SSDC0_R |= 0x0;
-                    }
-                    else if(1 == SS) {
-                        ADC0_SSOP1_R |= 0b1;
-                        ADC0_SSDC0_R |= 0x0;
-                    }
-                    else if(2 == SS) {
-                        ADC0_SSOP2_R |= 0b1;
-                        ADC0_SSDC0_R |= 0x0;
-                    }
-                    else /*(3 == SS) */ {
-                        ADC0_SSOP3_R |= 0b1;
-                        ADC0_SSDC0_R |= 0x0;
-                    }
-                    break;
-
-            case 1: ADC0_DCCTL1_R |= 0x10;
-                    ADC0_DCCTL1_R |= CIM;
-                    ADC0_DCCTL1_R |= (CIC << 2);
-                    ADC0_DCCMP1_R |= COMP0;
-                    ADC0_DCCMP1_R |= (COMP1 << 16);
-                    /* enable the digital comparator on the sample sequencer */
-                    if(0 == SS) {
-                        ADC0_SSOP0_R |= 0b1;
-                        ADC0_SSDC0_R |= 0x0;
-                    }
-                    else if(1 == SS) {
-                        ADC0_SSOP1_R |= 0b1;
-                        ADC0_SSDC1_R |= 0x0;
-                    }
-                    else if(2 == SS) {
-                        ADC0_SSOP2_R |= 0b1;
-                        ADC0_SSDC1_R |= 0x0;
-                    }
-                    else /*(3 == SS) */ {
-                        ADC0_SSOP3_R |= 0b1;
-                        ADC0_SSDC1_R |= 0x0;
-                    }
-                    break;
-
-            case 2: ADC0_DCCTL2_R |= 0x10;
-                    ADC0_DCCTL2_R |= CIM;
-                    ADC0_DCCTL2_R |= (CIC << 2);
-                    ADC0_DCCMP2_R |= COMP0;
-                    ADC0_DCCMP2_R |= (COMP1 << 16);
-                    break;
-
-            case 3: ADC0_DCCTL3_R |= 0x10;
-                    ADC0_DCCTL3_R |= CIM;
-                    ADC0_DCCTL3_R |= (CIC << 2);
-                    ADC0_DCCMP3_R |= COMP0;
-                    ADC0_DCCMP3_R |= (COMP1 << 16);
-                    break;
-
-            case 4: ADC0_DCCTL4_R |= 0x10;
-                    ADC0_DCCTL4_R |= CIM;
-                    ADC0_DCCTL4_R |= (CIC << 2);
-                    ADC0_DCCMP4_R |= COMP0;
-                    ADC0_DCCMP4_R |= (COMP1 << 16);
-                    break;
-
-            case 5: ADC0_DCCTL5_R |= 0x10;
-                    ADC0_DCCTL5_R |= CIM;
-                    ADC0_DCCTL5_R |= (CIC << 2);
-                    ADC0_DCCMP5_R |= COMP0;
-                    ADC0_DCCMP5_R |= (COMP1 << 16);
-                    break;
-
-            case 6: ADC0_DCCTL6_R |= 0x10;
-                    ADC0_DCCTL6_R |= CIM;
-                    ADC0_DCCTL6_R |= (CIC << 2);
-                    ADC0_DCCMP6_R |= COMP0;
-                    ADC0_DCCMP6_R |= (COMP1 << 16);
-                    break;
-
-            case 7: ADC0_DCCTL7_R |= 0x10;
-                    ADC0_DCCTL7_R |= CIM;
-                    ADC0_DCCTL7_R |= (CIC << 2);
-                    ADC0_DCCMP7_R |= COMP0;
-                    ADC0_DCCMP7_R |= (COMP1 << 16);
-                    break;
-        }
-    }
-
-    /* Enable interrupts last */
-    if(SSI >= 0) {
-        switch (SSI) {
-
-            case 0: ADC0_IM_R |= 0x01;
-                priority = (pri << 21); /* 4n+2. bits 23:21. n = 3*/
-                NVIC_PRI3_R |= priority;
-                NVIC_EN0_R |= 0x00004000; /* bit 14 */
-                break;
-
-            case 1: ADC0_IM_R |= 0x02;
-                priority = (pri << 29); /* 4n+3. bits 31:29 */
-                NVIC_PRI3_R |= priority;
-                NVIC_EN0_R |= 0x00008000; /* bit 15 */
-                break;
-
-            case 2: ADC0_IM_R |= 0x04;
-                priority = (pri << 5); /* 4n. bits 7:5. n = 4 */
-                NVIC_PRI4_R |= priority;
-                NVIC_EN0_R |= 0x00010000; /* bit 16 */
-                break;
-
-            case 3: ADC0_IM_R |= 0x08;
-                priority = (pri << 13); /* 4n+1. bits 15:13. n = 4 */
-                NVIC_PRI4_R |= priority;
-                NVIC_EN0_R |= 0x00020000; /* bit 17 */
-                break;
-
-            default:    exit(EXIT_FAILURE);
-        }
+        dc.comparator = DC;
+        dc.sequencer = SS;
+        dc.step = 0;
+        dc.condition = CIC;
+        dc.mode = CIM;
+        dc.comp0 = COMP0;
+        dc.comp1 = COMP1;
+        ADC_comparators(adc, &dc, 1, adcEvents[0], pri);
+        if(!CIE)
+            adc->DCCTL[DC] &= ~0x10;
     }
 
     /* Enable interrupts last */
     if(DCSS >= 0) {
-        switch (DCSS) {
-
-            case 0: ADC0_IM_R |= 0x00010000;
-                break;
-
-            case 1: ADC0_IM_R |= 0x00020000;
-                break;
-
-            case 2: ADC0_IM_R |= 0x00040000;
-                break;
-
-            case 3: ADC0_IM_R |= 0x00080000;
-                break;
-
-            default:    exit(EXIT_FAILURE);
-        }
+        adc->IM |= 0x10000UL << DCSS; //p.777 - DCONSSn
+        ADC_nvic(adc, DCSS, pri);
     }
+    if(SSI >= 0)
+        ADC_enableInterrupt(adc, SSI, pri);
 }
 
 /*
  * Initialize the Analog to Digital Converter 1 with sample interrupt enable,
- * end of sequence, and sample sequencer 2. temperature is enabled.
- * Interrupts are off.
+ * end of sequence, and sample sequencer 2. Temperature is off, see
+ * ADC/temperature.h for the sensor. Interrupts are off.
  *
  * param samplingRate
- *          0x01 - 125ksps
- *          0x03 - 250ksps
- *          0x05 - 500ksps
- *          0x07 - 1Msps
+ *          As for ADC_init
  *
  * param trigger
- *          0x00 - Processor (Default)
- *          0x01 - Analog comparator 0
- *          0x02 - Analog comparator 1
- *          0x04 - External (GPIO Pins)
- *          0x05 - Timer
- *          0x0F - Always (continuously sample)
+ *          As for ADC_init
  *
  * param sampleSelect
  *          0x01 - 0x09 corresponds to AIN0 - AIN9
@@ -379,39 +962,30 @@ void ADC0_interrupt(int SSI, int DCSS, int SS, int DC, int CIE, int CIC, int CIM
  */
 void init_adc1(unsigned int samplingRate, unsigned int trigger, unsigned int sampleSelect) {
 
-    volatile unsigned long delay_clk;
+    ADC_init(ADC1_MODULE, 2, samplingRate, trigger, &sampleSelect, 1);
+}
 
-    SYSCTL_RCGCADC_R |= 0x02; //p.322 - to enable clock for ADC module 1
-    delay_clk = SYSCTL_RCGCADC_R; //dummy operation for clock to settle
-    delay_clk = SYSCTL_RCGCADC_R; //dummy operation for clock to settle
+/*
+ * Start a conversion on ADC1 sample sequencer 2 and return straight away.
+ *
+ * param done
+ *          Called from ADC1Seq2_Handler() with the result when the
+ *          conversion is complete. Use 0 to collect the result with
+ *          ADC1_pollSeq2() instead.
+ */
+void ADC1_startSeq2(void (*done)(uint32_t)) {
 
-    ADC1_PC_R |= samplingRate;  //p.840 - to select sampling rate
-    ADC1_SSPRI_R |= 0x0123;   //p.791 - to select SS priority. ADC3 has the highest priority
-    ADC1_ACTSS_R &= ~0x0004; //p.774 - disable ADC during setup
-
-    //p.785 - set trigger mode
-    switch(trigger) {
-
-        case 0x00:  ADC1_EMUX_R &= ~0xF000;
-                    break;
-        case 0x01:  ADC1_EMUX_R |= 0x1000;
-                    break;
-        case 0x02:  ADC1_EMUX_R |= 0x2000;
-                    break;
-        case 0x04:  ADC1_EMUX_R |= 0x4000;
-                    break;
-        case 0x05:  ADC1_EMUX_R |= 0x5000;
-                    break;
-        case 0x0F:  ADC1_EMUX_R |= 0xF000;
-                    break;
-        default:    exit(EXIT_FAILURE);
-    }
-    ADC1_SSMUX2_R = (ADC1_SSMUX2_R & 0xFFFFF0FF) + sampleSelect; //Clear SS2 field
-    ADC1_SSCTL2_R |= 0b0110; //p.826 - to configure sequencer control
-    ADC1_IM_R &= ~0x0004; //p. 777 - disable SS2 interrupts
+    ADC_startSequence(ADC1_MODULE, 2, done);
+}
 
-    /* re-initiate after setup */
-    ADC1_ACTSS_R |= 0x0004; //p.774 -
+/*
+ * Collect the result of a conversion started by ADC1_startSeq2(0)
+ *
+ * returns 0 if the result was stored, -1 if the conversion is still running.
+ */
+int ADC1_pollSeq2(uint32_t *result) {
+
+    return ADC_pollSequence(ADC1_MODULE, 2, result, 1) < 0 ? -1 : 0;
 }
 
 /*
@@ -419,17 +993,5 @@ void init_adc1(unsigned int samplingRate, unsigned int trigger, unsigned int sam
  */
 uint32_t ADC1_InSeq2(void) {
 
-    uint32_t result;
-
-    ADC1_PSSI_R |= 0x0004; //p.795 - Begin sampling on sample sequencer 2
-
-    /* Poll the conversion completion bit of SS2 */
-    while((ADC1_RIS_R & 0x04) == 0x00);
-
-    /* Read FIFO for the value, which is the value obtained by the ADC */
-    result = ADC1_SSFIFO2_R & 0xFFF;
-
-    ADC1_ISC_R = 0x0004; //Clear the bit by writing to it.
-
-    return result;
+    return ADC_sample(ADC1_MODULE, 2);
 }
@@ -9,10 +9,162 @@
 #ifndef ADC_H_
 #define ADC_H_
 
+/*
+ * Registers of one sample sequencer. The four sequencers of a module are
+ * laid out 0x20 apart starting at offset 0x040, p.801.
+ */
+typedef struct {
+    volatile uint32_t SSMUX;
+    volatile uint32_t SSCTL;
+    volatile uint32_t SSFIFO;
+    volatile uint32_t SSFSTAT;
+    volatile uint32_t SSOP;
+    volatile uint32_t SSDC;
+    uint32_t reserved[2];
+} adcSequencer;
+
+/*
+ * Register block of one ADC module, p.772. ADC0 and ADC1 are identical, so
+ * every routine in adc.c takes one of these instead of being written twice.
+ */
+typedef struct {
+    volatile uint32_t ACTSS;        /* 0x000 */
+    volatile uint32_t RIS;
+    volatile uint32_t IM;
+    volatile uint32_t ISC;
+    volatile uint32_t OSTAT;        /* 0x010 */
+    volatile uint32_t EMUX;
+    volatile uint32_t USTAT;
+    volatile uint32_t TSSEL;
+    volatile uint32_t SSPRI;        /* 0x020 */
+    volatile uint32_t SPC;
+    volatile uint32_t PSSI;
+    uint32_t reserved0;
+    volatile uint32_t SAC;          /* 0x030 */
+    volatile uint32_t DCISC;
+    volatile uint32_t CTL;
+    uint32_t reserved1;
+    adcSequencer SS[4];             /* 0x040 */
+    uint32_t reserved2[784];
+    volatile uint32_t DCRIC;        /* 0xD00 */
+    uint32_t reserved3[63];
+    volatile uint32_t DCCTL[8];     /* 0xE00 */
+    uint32_t reserved4[8];
+    volatile uint32_t DCCMP[8];     /* 0xE40 */
+    uint32_t reserved5[88];
+    volatile uint32_t PP;           /* 0xFC0 */
+    volatile uint32_t PC;
+    volatile uint32_t CC;
+} adcModule;
+
+#define ADC0_MODULE ((adcModule *)0x40038000)
+#define ADC1_MODULE ((adcModule *)0x40039000)
+
+/* Digital comparator regions, CIC, p.836 */
+#define ADC_DC_LOW_BAND             0x0     /* data < COMP0 */
+#define ADC_DC_MID_BAND             0x1     /* COMP0 <= data < COMP1 */
+#define ADC_DC_HIGH_BAND            0x3     /* COMP1 <= data */
+
+/* Digital comparator interrupt modes, CIM */
+#define ADC_DC_ALWAYS               0x0     /* every sample in the region */
+#define ADC_DC_ONCE                 0x1     /* on entering the region */
+#define ADC_DC_HYSTERESIS_ALWAYS    0x2     /* until the opposite region is seen */
+#define ADC_DC_HYSTERESIS_ONCE      0x3     /* once, re-armed by the opposite region */
+
+/* One row of the table given to ADC_comparators() */
+typedef struct {
+    int comparator;     /* 0 - 7 */
+    int sequencer;      /* 0 - 3 */
+    int step;           /* step of the sequencer whose result is compared */
+    int condition;      /* ADC_DC_*_BAND */
+    int mode;           /* ADC_DC_ALWAYS etc. */
+    uint16_t comp0;     /* thresholds, 0 - 4095, comp0 <= comp1 */
+    uint16_t comp1;
+} adcComparator;
+
+/* ADCPSSI bits for starting both modules together, p.795 */
+#define ADC_PSSI_GSYNC              0x80000000
+#define ADC_PSSI_SYNCWAIT           0x08000000
+
+/* One sample from each module, taken at the same instant */
+typedef struct {
+    uint16_t adc0;
+    uint16_t adc1;
+} adcPair;
+
+/* Channel number for ADC_init() that selects the temperature sensor, TSn */
+#define ADC_CHANNEL_TEMP            0x10
+
+/* Depth of the FIFO, and so the most steps, of each sequencer */
+#define ADC_SS_DEPTH(ss) ((ss) == 0 ? 8 : ((ss) == 3 ? 1 : 4))
+
+/*
+ * The hot path. With a constant module and sequencer these come down to a
+ * few loads and stores, e.g. ADC_sample(ADC0_MODULE, 3).
+ */
+static inline void ADC_start(adcModule *adc, int ss) {
+
+    adc->PSSI = 1UL << ss; //p.795 - Begin sampling on the sequencer
+}
+
+static inline int ADC_done(adcModule *adc, int ss) {
+
+    return (adc->RIS >> ss) & 0x01;
+}
+
+static inline uint32_t ADC_readFifo(adcModule *adc, int ss) {
+
+    return adc->SS[ss].SSFIFO & 0xFFF;
+}
+
+/*
+ * Take one sample and wait for it. The sequencer interrupt is masked first,
+ * otherwise a handler left enabled by ADC_startSequence() would take the
+ * result and clear RIS before the loop below sees it.
+ */
+static inline uint32_t ADC_sample(adcModule *adc, int ss) {
+
+    uint32_t result;
+
+    adc->IM &= ~(1UL << ss);
+    ADC_start(adc, ss);
+    while(!ADC_done(adc, ss));
+    result = ADC_readFifo(adc, ss);
+    adc->ISC = 1UL << ss; //Clear the bit by writing to it.
+
+    return result;
+}
+
+void ADC_init(adcModule *, int, unsigned int, unsigned int, const unsigned int *, int);
+void ADC_startSequence(adcModule *, int, void (*)(uint32_t));
+int ADC_pollSequence(adcModule *, int, uint32_t *, int);
+int ADC_readSequence(adcModule *, int, uint32_t *, int);
+void ADC_attachHandler(adcModule *, int, void (*)(void));
+void (*ADC_handlerOf(adcModule *, int))(void);
+void ADC_enableInterrupt(adcModule *, int, int);
+void ADC_oversample(adcModule *, int);
+void ADC_comparators(adcModule *, const adcComparator *, int, void (*)(int), int);
+void ADC_comparatorOff(adcModule *, int);
+uint32_t ADC_comparatorState(adcModule *);
+
 void init_adc0(unsigned int, unsigned int, unsigned int);
 uint32_t ADC0_InSeq3(void);
+void ADC0_startSeq3(void (*)(uint32_t));
+int ADC0_pollSeq3(uint32_t *);
+void init_adc0_scan(unsigned int, unsigned int, const unsigned int *, int);
+int ADC0_InSeq0(uint32_t *);
+void init_adc0_acquire(unsigned int, unsigned int, uint32_t, uint16_t *, uint16_t *, int, void (*)(uint16_t *, int), int);
+void init_adc0_acquireDMA(unsigned int, unsigned int, uint32_t, uint16_t *, uint16_t *, int, void (*)(uint16_t *, int), int);
+void ADC0_stopAcquire(void);
+void ADC0_acquireStats(unsigned long *, unsigned long *);
 void init_adc1(unsigned int, unsigned int, unsigned int);
-uint32_t ADC0_InSeq2(void);
+uint32_t ADC1_InSeq2(void);
+void ADC1_startSeq2(void (*)(uint32_t));
+int ADC1_pollSeq2(uint32_t *);
+void ADC_syncInit(unsigned int, unsigned int, unsigned int);
+void ADC_syncSample(adcPair *);
+void ADC_syncAcquire(unsigned int, unsigned int, unsigned int, uint32_t, adcPair *, adcPair *, int, void (*)(adcPair *, int), int);
+void ADC_stopSyncAcquire(void);
 void ADC0_interrupt(int, int, int, int, int, int, int, int, int, int);
 
 
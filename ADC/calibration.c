@@ -0,0 +1,334 @@
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ADC/calibration.h"
+#include "DSP/dsp.h"
+#ifndef CAL_HOST
+#include "EEPROM/eeprom.h"
+#endif
+
+/* Identifies a saved record, "CAL1" */
+#define CAL_MAGIC 0x43414C31
+
+/* What is set and saved for each channel */
+typedef struct {
+    int32_t gain;                   /* Q16, 65536 is 1.0 */
+    int32_t offset;                 /* Q16 counts */
+    int16_t corrections[CAL_POINTS]; /* 1/16 count, added at codes 0, 256 ... */
+} calChannel;
+
+/* Words one channel takes in the EEPROM: gain, offset and the corrections in pairs */
+#define CAL_CHANNEL_WORDS (2 + (CAL_POINTS + 1) / 2)
+
+calSegment calTable[CAL_CHANNELS][CAL_SEGMENTS];
+static calChannel calChannels[CAL_CHANNELS];
+
+/*
+ * Fold the line and the corrections of a channel into calTable. The
+ * segment from code x0 to x1 gets the line through the corrected values
+ * at each end.
+ */
+static void CAL_build(int channel) {
+
+    const calChannel *c = &calChannels[channel];
+    int64_t y0, y1, gain;
+    int32_t x0;
+    int s;
+
+    for(s = 0; s < CAL_SEGMENTS; s++) {
+        x0 = s * 256;
+        y0 = (int64_t)x0 * c->gain + c->offset + ((int64_t)c->corrections[s] << 12);
+        y1 = (int64_t)(x0 + 256) * c->gain + c->offset + ((int64_t)c->corrections[s + 1] << 12);
+        gain = (y1 - y0) / 256;
+        calTable[channel][s].gain = (int32_t)gain;
+        calTable[channel][s].offset = (int32_t)(y0 - x0 * gain + 0x8000); //rounds the >> 16
+    }
+}
+
+static void CAL_check(int channel) {
+
+    if(channel < 0 || channel >= CAL_CHANNELS)
+        exit(EXIT_FAILURE);
+}
+
+/*
+ * Set every channel back to no correction
+ */
+void CAL_init(void) {
+
+    int channel;
+
+    memset(calChannels, 0, sizeof(calChannels));
+    for(channel = 0; channel < CAL_CHANNELS; channel++) {
+        calChannels[channel].gain = 65536;
+        CAL_build(channel);
+    }
+}
+
+/*
+ * param gain
+ *          Q16, e.g. 65536 for 1.0
+ *
+ * param offset
+ *          Q16 counts, added after the gain.
+ */
+void CAL_setLinear(int channel, int32_t gain, int32_t offset) {
+
+    CAL_check(channel);
+    calChannels[channel].gain = gain;
+    calChannels[channel].offset = offset;
+    CAL_build(channel);
+}
+
+/*
+ * Work out the gain and offset from two known inputs, e.g. near 10% and
+ * 90% of full scale.
+ *
+ * param raw0, raw1
+ *          The codes read.
+ *
+ * param true0, true1
+ *          The codes they should have been.
+ */
+void CAL_twoPoint(int channel, uint16_t raw0, uint16_t true0, uint16_t raw1, uint16_t true1) {
+
+    int32_t gain;
+
+    CAL_check(channel);
+    if(raw1 == raw0)
+        exit(EXIT_FAILURE);
+
+    gain = (int32_t)((((int64_t)true1 - true0) << 16) / ((int32_t)raw1 - raw0));
+    CAL_setLinear(channel, gain, ((int32_t)true0 << 16) - (int32_t)raw0 * gain);
+}
+
+/*
+ * param corrections
+ *          CAL_POINTS values in 1/16 count, added to the line at codes 0,
+ *          256 ... 4096 and interpolated between.
+ */
+void CAL_setCorrections(int channel, const int16_t *corrections) {
+
+    CAL_check(channel);
+    memcpy(calChannels[channel].corrections, corrections, sizeof(calChannels[channel].corrections));
+    CAL_build(channel);
+}
+
+/*
+ * Correct a block in place, e.g. from an acquisition blockDone callback
+ */
+void CAL_block(int channel, uint16_t *samples, int n) {
+
+    int i;
+
+    for(i = 0; i < n; i++)
+        samples[i] = CAL_apply(channel, samples[i]);
+}
+
+#ifndef CAL_HOST
+
+/*
+ * Write every channel's settings to the EEPROM, after a magic number and
+ * followed by a checksum. Call init_eeprom() first.
+ *
+ * returns 0, or -1 if the EEPROM refused the write.
+ */
+int CAL_save(void) {
+
+    uint32_t record[2 + CAL_CHANNELS * CAL_CHANNEL_WORDS];
+    uint32_t sum = 0;
+    int channel, k, w = 0;
+
+    record[w++] = CAL_MAGIC;
+    for(channel = 0; channel < CAL_CHANNELS; channel++) {
+        record[w++] = (uint32_t)calChannels[channel].gain;
+        record[w++] = (uint32_t)calChannels[channel].offset;
+        for(k = 0; k < CAL_POINTS; k += 2) {
+            record[w] = (uint16_t)calChannels[channel].corrections[k];
+            if(k + 1 < CAL_POINTS)
+                record[w] |= (uint32_t)(uint16_t)calChannels[channel].corrections[k + 1] << 16;
+            w++;
+        }
+    }
+    for(k = 0; k < w; k++)
+        sum += record[k];
+    record[w++] = ~sum;
+
+    return EEPROM_write(CAL_EEPROM_WORD, record, w);
+}
+
+/*
+ * Read the settings saved by CAL_save(). Call init_eeprom() first.
+ *
+ * returns 0, or -1 if nothing valid was saved, in which case every channel
+ * is left uncorrected.
+ */
+int CAL_load(void) {
+
+    uint32_t record[2 + CAL_CHANNELS * CAL_CHANNEL_WORDS];
+    uint32_t sum = 0;
+    int channel, k, w = 1;
+
+    EEPROM_read(CAL_EEPROM_WORD, record, sizeof(record) / sizeof(record[0]));
+    for(k = 0; k < (int)(sizeof(record) / sizeof(record[0])) - 1; k++)
+        sum += record[k];
+
+    CAL_init();
+    if(record[0] != CAL_MAGIC || record[k] != ~sum)
+        return -1;
+
+    for(channel = 0; channel < CAL_CHANNELS; channel++) {
+        calChannels[channel].gain = (int32_t)record[w++];
+        calChannels[channel].offset = (int32_t)record[w++];
+        for(k = 0; k < CAL_POINTS; k += 2) {
+            calChannels[channel].corrections[k] = (int16_t)(record[w] & 0xFFFF);
+            if(k + 1 < CAL_POINTS)
+                calChannels[channel].corrections[k + 1] = (int16_t)(record[w] >> 16);
+            w++;
+        }
+        CAL_build(channel);
+    }
+
+    return 0;
+}
+
+#endif
+
+/*
+ * Differential and integral non-linearity from a code histogram. Feed the
+ * ADC a slow ramp (or a simulated one on the host) that covers full scale
+ * evenly, count how often each code comes up, and pass the counts here.
+ * The end codes 0 and 4095 also collect everything beyond the range, so
+ * they are left out.
+ *
+ * param histogram
+ *          4096 counts.
+ *
+ * param dnl, inl
+ *          4096 results each in thousandths of an LSB, or 0 if not wanted.
+ *          INL is the end point kind, the sum of the DNL.
+ */
+void CAL_linearity(const uint32_t *histogram, int16_t *dnl, int16_t *inl, calLinearity *summary) {
+
+    uint64_t total = 0;
+    int64_t d, sum = 0;
+    int code;
+
+    summary->maxDnl = summary->maxInl = INT32_MIN;
+    summary->minDnl = summary->minInl = INT32_MAX;
+    summary->missingCodes = 0;
+
+    for(code = 1; code < 4095; code++)
+        total += histogram[code];
+    if(total == 0)
+        exit(EXIT_FAILURE);
+
+    for(code = 0; code < 4096; code++) {
+        if(code == 0 || code == 4095) {
+            d = 0;
+        }
+        else {
+            /* Width of the code over the ideal width, less one */
+            d = ((int64_t)histogram[code] * 4094 * 1000 + (int64_t)(total / 2)) / (int64_t)total - 1000;
+            if(histogram[code] == 0)
+                summary->missingCodes++;
+        }
+        sum += d;
+
+        if(dnl)
+            dnl[code] = (int16_t)d;
+        if(inl)
+            inl[code] = (int16_t)(sum < -32768 ? -32768 : (sum > 32767 ? 32767 : sum));
+        if(d > summary->maxDnl)
+            summary->maxDnl = (int32_t)d;
+        if(d < summary->minDnl)
+            summary->minDnl = (int32_t)d;
+        if(sum > summary->maxInl)
+            summary->maxInl = (int32_t)sum;
+        if(sum < summary->minInl)
+            summary->minInl = (int32_t)sum;
+    }
+}
+
+/*
+ * Use an INL curve from CAL_linearity() as the corrections of a channel,
+ * taking it at every 256th code. Where the INL is positive the codes so far
+ * have been wide, so the reading is low by that much and it is added back.
+ */
+void CAL_correctionsFromInl(int channel, const int16_t *inl) {
+
+    int16_t corrections[CAL_POINTS];
+    int k;
+
+    for(k = 0; k < CAL_POINTS; k++)
+        corrections[k] = (int16_t)((int32_t)inl[(k * 256 > 4095) ? 4095 : k * 256] * 16 / 1000);
+    CAL_setCorrections(channel, corrections);
+}
+
+/*
+ * log2 of x in Q10, for x > 0. The whole part from the top bit, then one
+ * fraction bit per squaring of the mantissa.
+ */
+static int32_t CAL_log2(uint32_t x) {
+
+    int32_t result = 0;
+    uint64_t mantissa;
+    int bit;
+
+    while(x >> (result + 1))
+        result++;
+    mantissa = ((uint64_t)x << 30) >> result; //Q30, 1.0 to just under 2.0
+    result <<= 10;
+
+    for(bit = 512; bit; bit >>= 1) {
+        mantissa = (mantissa * mantissa) >> 30;
+        if(mantissa >= (2ULL << 30)) {
+            mantissa >>= 1;
+            result += bit;
+        }
+    }
+
+    return result;
+}
+
+/*
+ * Effective number of bits from samples of a linear ramp, in hundredths of
+ * a bit. A straight line is fitted through the samples and the RMS of what
+ * is left is compared with the 1/sqrt(12) LSB of an ideal 12 bit ADC. All
+ * integer, so it also runs on the target without pulling in libm.
+ *
+ * param n
+ *          Number of samples, 3 - 65535, evenly spaced along the ramp.
+ */
+int32_t CAL_enob(const uint16_t *samples, int n) {
+
+    int64_t sum = 0, sxy = 0, sxx, x, mean, slope, residual;
+    uint64_t error = 0;
+    uint32_t rms;
+    int i;
+
+    if(n < 3 || n > 65535)
+        exit(EXIT_FAILURE);
+
+    /* x = 2i - (n - 1) runs symmetrically about 0, so the fit separates */
+    for(i = 0; i < n; i++) {
+        x = 2 * i - (n - 1);
+        sum += samples[i];
+        sxy += x * samples[i];
+    }
+    sxx = (int64_t)n * ((int64_t)n * n - 1) / 3;
+    mean = (sum << 16) / n; //Q16
+    slope = (sxy << 16) / sxx; //Q16 per step of x
+
+    for(i = 0; i < n; i++) {
+        x = 2 * i - (n - 1);
+        residual = (((int64_t)samples[i] << 16) - mean - slope * x) >> 8; //Q8
+        error += (uint64_t)(residual * residual);
+    }
+    rms = DSP_sqrt(error / n); //Q8
+    if(rms == 0)
+        return 1200;
+
+    /* 12 - log2(rms sqrt(12)), with log2(sqrt(12)) = 1836 in Q10 and 8 more for Q8 */
+    return (int32_t)((((20 << 10) - 1836 - CAL_log2(rms)) * 100 + 512) >> 10);
+}
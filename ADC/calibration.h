@@ -0,0 +1,76 @@
+/*
+ * calibration.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: bjh885
+ *
+ * Per channel correction of raw ADC codes. Each channel has a gain and
+ * offset, plus an optional correction at every 256th code for what a
+ * straight line cannot fix. Both are folded into one gain and offset per
+ * 256 code segment, so correcting a sample is a table lookup and a single
+ * multiply-add. The settings are kept in the EEPROM.
+ *
+ * Build with -DCAL_HOST to use the linearity functions on the host.
+ */
+
+#ifndef CALIBRATION_H_
+#define CALIBRATION_H_
+
+#include <inttypes.h>
+
+#define CAL_CHANNELS 12                 /* AIN0 - AIN11 */
+#define CAL_SEGMENTS 16                 /* 256 codes each */
+#define CAL_POINTS (CAL_SEGMENTS + 1)   /* codes 0, 256 ... 4096 */
+
+/* First EEPROM word of the saved settings. They take 134 words */
+#define CAL_EEPROM_WORD 0
+
+/* Corrected = (raw * gain + offset) >> 16 over one segment */
+typedef struct {
+    int32_t gain;
+    int32_t offset;
+} calSegment;
+
+/* Results of CAL_linearity(), in thousandths of an LSB */
+typedef struct {
+    int32_t maxDnl;
+    int32_t minDnl;
+    int32_t maxInl;
+    int32_t minInl;
+    int missingCodes;
+} calLinearity;
+
+extern calSegment calTable[CAL_CHANNELS][CAL_SEGMENTS];
+
+/*
+ * Correct one raw 12 bit code from channel. This is the whole cost in the
+ * sample path.
+ */
+static inline uint16_t CAL_apply(int channel, uint16_t raw) {
+
+    const calSegment *segment = &calTable[channel][raw >> 8];
+    int32_t corrected = (raw * segment->gain + segment->offset) >> 16;
+
+    if(corrected < 0)
+        return 0;
+    if(corrected > 4095)
+        return 4095;
+    return (uint16_t)corrected;
+}
+
+void CAL_init(void);
+void CAL_setLinear(int, int32_t, int32_t);
+void CAL_twoPoint(int, uint16_t, uint16_t, uint16_t, uint16_t);
+void CAL_setCorrections(int, const int16_t *);
+void CAL_block(int, uint16_t *, int);
+
+#ifndef CAL_HOST
+int CAL_save(void);
+int CAL_load(void);
+#endif
+
+void CAL_linearity(const uint32_t *, int16_t *, int16_t *, calLinearity *);
+void CAL_correctionsFromInl(int, const int16_t *);
+int32_t CAL_enob(const uint16_t *, int);
+
+#endif /* CALIBRATION_H_ */
@@ -0,0 +1,124 @@
+#include <inttypes.h>
+#include <stdlib.h>
+#include "cic.h"
+
+/*
+ * Set up a decimator. The full sum of a 12 bit input has
+ * 12 + order * log2(ratio) bits, which must fit in 32.
+ *
+ * param order
+ *          Number of integrator/comb stages, 1 - 3. Higher orders reject
+ *          more of the noise above the output rate.
+ *
+ * param ratio
+ *          Input samples per output sample, 2 - 1024 and a power of two.
+ *
+ * param outBits
+ *          Width of the results, e.g. 16. If the full sum is wider it is
+ *          shifted down to this many bits. Use 0 to keep every bit.
+ */
+void CIC_init(cicFilter *cic, int order, int ratio, int outBits) {
+
+    int log2Ratio = 0;
+    int sumBits;
+    int i;
+
+    if(order < 1 || order > CIC_MAX_ORDER)
+        exit(EXIT_FAILURE);
+    if(ratio < 2 || ratio > 1024 || (ratio & (ratio - 1)))
+        exit(EXIT_FAILURE);
+
+    while((1 << log2Ratio) < ratio)
+        log2Ratio++;
+    sumBits = 12 + order * log2Ratio;
+    if(sumBits > 32)
+        exit(EXIT_FAILURE);
+
+    cic->order = order;
+    cic->ratio = ratio;
+    cic->shift = (outBits > 0 && sumBits > outBits) ? sumBits - outBits : 0;
+    cic->count = 0;
+    for(i = 0; i < CIC_MAX_ORDER; i++) {
+        cic->integrator[i] = 0;
+        cic->comb[i] = 0;
+    }
+}
+
+/*
+ * Feed one raw sample.
+ *
+ * param out
+ *          Set to the next result when one is ready.
+ *
+ * returns 1 if a result was stored, otherwise 0.
+ */
+int CIC_push(cicFilter *cic, uint16_t sample, uint32_t *out) {
+
+    uint32_t acc = sample;
+    uint32_t previous;
+    int i;
+
+    /* Integrators run at the input rate */
+    for(i = 0; i < cic->order; i++) {
+        cic->integrator[i] += acc;
+        acc = cic->integrator[i];
+    }
+
+    if(++cic->count < cic->ratio)
+        return 0;
+    cic->count = 0;
+
+    /* Combs run at the output rate, with a differential delay of one */
+    for(i = 0; i < cic->order; i++) {
+        previous = cic->comb[i];
+        cic->comb[i] = acc;
+        acc -= previous;
+    }
+
+    *out = acc >> cic->shift;
+    return 1;
+}
+
+/*
+ * Decimate a block, e.g. one delivered by init_adc0_acquireDMA(). The
+ * integrator state stays in registers for the whole block.
+ *
+ * param out
+ *          Room for n / ratio + 1 results.
+ *
+ * returns the number of results stored.
+ */
+int CIC_block(cicFilter *cic, const uint16_t *in, int n, uint32_t *out) {
+
+    uint32_t i0 = cic->integrator[0];
+    uint32_t i1 = cic->integrator[1];
+    uint32_t i2 = cic->integrator[2];
+    int count = cic->count;
+    int produced = 0;
+    uint32_t acc, previous;
+    int i, k;
+
+    for(k = 0; k < n; k++) {
+        i0 += in[k];
+        i1 += i0;
+        i2 += i1;
+        if(++count < cic->ratio)
+            continue;
+        count = 0;
+
+        acc = (cic->order == 1) ? i0 : (cic->order == 2) ? i1 : i2;
+        for(i = 0; i < cic->order; i++) {
+            previous = cic->comb[i];
+            cic->comb[i] = acc;
+            acc -= previous;
+        }
+        out[produced++] = acc >> cic->shift;
+    }
+
+    cic->integrator[0] = i0;
+    cic->integrator[1] = i1;
+    cic->integrator[2] = i2;
+    cic->count = count;
+
+    return produced;
+}
@@ -0,0 +1,38 @@
+/*
+ * cic.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: bjh885
+ *
+ * Cascaded integrator-comb decimator for ADC samples. Each output is the
+ * sum of ratio^order raw samples, so with white noise every doubling of the
+ * ratio buys about half a bit. An order of 1 is a plain boxcar average.
+ * The integrators wrap in 32 bits, which the combs undo exactly, so no
+ * sample is ever clamped. Combine with ADC_oversample() so the ADC averages
+ * in hardware first and this only sees the slower stream. host/cic_enob.c
+ * measures the bits gained against a simulated noisy input: 1.5 LSB of
+ * noise needs about 1024x in total, e.g. ADCSAC 64x and order 2 at 16x, for
+ * 14 bits, and 4096x for 15.
+ */
+
+#ifndef CIC_H_
+#define CIC_H_
+
+#include <inttypes.h>
+
+#define CIC_MAX_ORDER 3
+
+typedef struct {
+    int order;              /* 1 - CIC_MAX_ORDER */
+    int ratio;              /* input samples per output, a power of two */
+    int shift;              /* drop this many bits from the sum */
+    int count;              /* input samples since the last output */
+    uint32_t integrator[CIC_MAX_ORDER];
+    uint32_t comb[CIC_MAX_ORDER];
+} cicFilter;
+
+void CIC_init(cicFilter *, int, int, int);
+int CIC_push(cicFilter *, uint16_t, uint32_t *);
+int CIC_block(cicFilter *, const uint16_t *, int, uint32_t *);
+
+#endif /* CIC_H_ */
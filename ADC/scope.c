@@ -0,0 +1,303 @@
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ADC/adc.h"
+#include "ADC/scope.h"
+
+/* The capture fed by SCOPE_start() */
+static scopeCapture *scopeActive = 0;
+
+/*
+ * param buffer
+ *          Room for length samples. This is the whole captured frame.
+ *
+ * param length
+ *          A power of two, e.g. 1024.
+ *
+ * param preTrigger
+ *          Samples to keep from before the trigger, 0 to length - 1.
+ */
+void SCOPE_init(scopeCapture *scope, uint16_t *buffer, int length, int preTrigger) {
+
+    if(length < 2 || (length & (length - 1)) || preTrigger < 0 || preTrigger >= length)
+        exit(EXIT_FAILURE);
+
+    scope->buffer = buffer;
+    scope->mask = (uint32_t)length - 1;
+    scope->preTrigger = preTrigger;
+    scope->type = SCOPE_RISING;
+    scope->level = 2048;
+    scope->slope = 0;
+    scope->state = SCOPE_IDLE;
+    scope->forced = 0;
+}
+
+/*
+ * param type
+ *          SCOPE_RISING, SCOPE_FALLING, SCOPE_ABOVE, SCOPE_BELOW, SCOPE_SLOPE
+ *          or SCOPE_EXTERNAL
+ *
+ * param level
+ *          Threshold in counts for the level and edge types.
+ *
+ * param slope
+ *          Counts per sample for SCOPE_SLOPE. Negative for a falling slope.
+ */
+void SCOPE_setTrigger(scopeCapture *scope, int type, uint16_t level, int16_t slope) {
+
+    if(type < SCOPE_RISING || type > SCOPE_EXTERNAL || level > 4095 ||
+       (type == SCOPE_SLOPE && slope == 0))
+        exit(EXIT_FAILURE);
+
+    scope->type = type;
+    scope->level = level;
+    scope->slope = slope;
+}
+
+/*
+ * Start looking for a trigger. Triggers are ignored until preTrigger
+ * samples have been stored, so the frame is always full.
+ */
+void SCOPE_arm(scopeCapture *scope) {
+
+    scope->state = SCOPE_IDLE; //SCOPE_block() leaves us alone while we set up
+    scope->phase = 0;
+    scope->written = 0;
+    scope->remaining = 0;
+    scope->forced = 0;
+    scope->state = SCOPE_ARMED; //last, all volatile so nothing moves past it
+}
+
+/*
+ * Trigger on the next sample stored, whatever its value. Safe to call from
+ * an interrupt, e.g. the event callback of ADC_comparators() watching the
+ * same input on ADC1.
+ */
+void SCOPE_triggerNow(scopeCapture *scope) {
+
+    scope->forced = 1;
+}
+
+/*
+ * Index in the block of the first sample that fires the trigger, or n
+ */
+static int SCOPE_search(scopeCapture *scope, const uint16_t *in, int n) {
+
+    uint16_t level = scope->level;
+    int32_t slope = scope->slope;
+    int32_t last = scope->last;
+    int i = 0;
+
+    switch(scope->type) {
+
+        case SCOPE_RISING:
+            if(!scope->phase) {
+                while(i < n && in[i] >= level)
+                    i++;
+                if(i == n)
+                    return n;
+                scope->phase = 1;
+            }
+            while(i < n && in[i] < level)
+                i++;
+            return i;
+
+        case SCOPE_FALLING:
+            if(!scope->phase) {
+                while(i < n && in[i] < level)
+                    i++;
+                if(i == n)
+                    return n;
+                scope->phase = 1;
+            }
+            while(i < n && in[i] >= level)
+                i++;
+            return i;
+
+        case SCOPE_ABOVE:
+            while(i < n && in[i] < level)
+                i++;
+            return i;
+
+        case SCOPE_BELOW:
+            while(i < n && in[i] >= level)
+                i++;
+            return i;
+
+        case SCOPE_SLOPE:
+            if(scope->written == 0)
+                last = in[i++]; //first sample since armed, nothing before it to compare
+            for(; i < n; last = in[i++]) {
+                if(slope > 0 ? ((int32_t)in[i] - last >= slope) : ((int32_t)in[i] - last <= slope))
+                    return i;
+            }
+            return n;
+
+        default:
+            return n;
+    }
+}
+
+/* Copy n samples into the circular buffer */
+static void SCOPE_store(scopeCapture *scope, const uint16_t *in, int n) {
+
+    uint32_t at = scope->written & scope->mask;
+    uint32_t first = scope->mask + 1 - at;
+
+    if((uint32_t)n <= first) {
+        memcpy(scope->buffer + at, in, n * sizeof(uint16_t));
+    }
+    else {
+        memcpy(scope->buffer + at, in, first * sizeof(uint16_t));
+        memcpy(scope->buffer, in + first, (n - first) * sizeof(uint16_t));
+    }
+    scope->written += n;
+}
+
+/*
+ * Feed a block of samples, e.g. from an acquisition blockDone callback
+ */
+void SCOPE_block(scopeCapture *scope, const uint16_t *in, int n) {
+
+    uint32_t wait;
+    int skip, hit;
+
+    while(n > 0) {
+        switch(scope->state) {
+
+            case SCOPE_ARMED:
+                /* Fill the pre-trigger part before looking */
+                if(scope->written < (uint32_t)scope->preTrigger) {
+                    wait = scope->preTrigger - scope->written;
+                    skip = (wait < (uint32_t)n) ? (int)wait : n;
+                    SCOPE_store(scope, in, skip);
+                    scope->last = in[skip - 1];
+                    in += skip;
+                    n -= skip;
+                    continue;
+                }
+
+                hit = scope->forced ? 0 : SCOPE_search(scope, in, n);
+                SCOPE_store(scope, in, hit);
+                if(hit == n) {
+                    scope->last = in[n - 1];
+                    return;
+                }
+
+                /* in[hit] is the trigger sample, the first after the split */
+                scope->trigger = scope->written;
+                scope->forced = 0;
+                scope->remaining = scope->mask + 1 - scope->preTrigger;
+                scope->state = SCOPE_TRIGGERED;
+                in += hit;
+                n -= hit;
+                break;
+
+            case SCOPE_TRIGGERED:
+                skip = (scope->remaining < (uint32_t)n) ? (int)scope->remaining : n;
+                SCOPE_store(scope, in, skip);
+                scope->remaining -= skip;
+                if(scope->remaining == 0)
+                    scope->state = SCOPE_DONE;
+                in += skip;
+                n -= skip;
+                break;
+
+            default:
+                return; //idle, or done and frozen until armed again
+        }
+    }
+}
+
+/*
+ * Copy out a finished capture in time order. The trigger sample is at
+ * out[preTrigger].
+ *
+ * param out
+ *          Room for the whole buffer length.
+ *
+ * returns the number of samples, or -1 if the capture is not done.
+ */
+int SCOPE_frame(const scopeCapture *scope, uint16_t *out) {
+
+    uint32_t start, i;
+
+    if(scope->state != SCOPE_DONE)
+        return -1;
+
+    start = scope->trigger - scope->preTrigger;
+    for(i = 0; i <= scope->mask; i++)
+        out[i] = scope->buffer[(start + i) & scope->mask];
+
+    return (int)scope->mask + 1;
+}
+
+/*
+ * Shrink a finished capture to width columns for the LCD. Each column
+ * gets the lowest and highest sample it covers as pixel rows, row 0 being
+ * the top of the plot, so a vertical line from top[x] to bottom[x] draws
+ * the trace without losing short spikes.
+ *
+ * param top, bottom
+ *          Room for width rows each.
+ *
+ * param height
+ *          Rows of the plot, 1 - 256.
+ */
+void SCOPE_envelope(const scopeCapture *scope, uint8_t *top, uint8_t *bottom, int width, int height) {
+
+    uint32_t length = scope->mask + 1;
+    uint32_t start = scope->trigger - scope->preTrigger;
+    uint32_t from, to, i;
+    uint16_t low, high, x;
+    int column;
+
+    if(scope->state != SCOPE_DONE || width < 1 || height < 1 || height > 256)
+        return;
+
+    for(column = 0; column < width; column++) {
+        from = length * column / width;
+        to = length * (column + 1) / width;
+        if(to == from)
+            to = from + 1;
+
+        low = 4095;
+        high = 0;
+        for(i = from; i < to; i++) {
+            x = scope->buffer[(start + i) & scope->mask];
+            if(x < low)
+                low = x;
+            if(x > high)
+                high = x;
+        }
+        top[column] = (uint8_t)(height - 1 - ((uint32_t)high * height >> 12));
+        bottom[column] = (uint8_t)(height - 1 - ((uint32_t)low * height >> 12));
+    }
+}
+
+/* blockDone for SCOPE_start() */
+static void SCOPE_blockDone(uint16_t *block, int n) {
+
+    if(scopeActive)
+        SCOPE_block(scopeActive, block, n);
+}
+
+/*
+ * Run the capture off init_adc0_acquireDMA(), so the CPU only sees whole
+ * blocks. The parameters after scope are as for that function. The scope
+ * is armed straight away. Call SCOPE_arm() again after each capture.
+ */
+void SCOPE_start(scopeCapture *scope, unsigned int samplingRate, unsigned int sampleSelect,
+                 uint32_t period, uint16_t *bufferA, uint16_t *bufferB, int blockSize, int pri) {
+
+    scopeActive = scope;
+    SCOPE_arm(scope);
+    init_adc0_acquireDMA(samplingRate, sampleSelect, period, bufferA, bufferB, blockSize,
+                         SCOPE_blockDone, pri);
+}
+
+void SCOPE_stop(void) {
+
+    ADC0_stopAcquire();
+    scopeActive = 0;
+}
@@ -0,0 +1,67 @@
+/*
+ * scope.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: bjh885
+ *
+ * Oscilloscope style capture on ADC0. Acquisition blocks are copied into a
+ * circular buffer until a trigger is found. The buffer then keeps filling
+ * until the samples after the trigger are in, and is frozen, holding
+ * preTrigger samples from before the trigger and the rest from after.
+ * Looking for the trigger costs one compare per sample, and nothing at all
+ * once the capture is done.
+ */
+
+#ifndef SCOPE_H_
+#define SCOPE_H_
+
+#include <inttypes.h>
+
+/* Trigger types */
+#define SCOPE_RISING        0   /* crosses level going up */
+#define SCOPE_FALLING       1   /* crosses level going down */
+#define SCOPE_ABOVE         2   /* any sample at or above level */
+#define SCOPE_BELOW         3   /* any sample below level */
+#define SCOPE_SLOPE         4   /* rises by slope or more in one sample, falls if slope < 0 */
+#define SCOPE_EXTERNAL      5   /* only SCOPE_triggerNow(), e.g. from a comparator event */
+
+/* Capture states */
+#define SCOPE_IDLE          0
+#define SCOPE_ARMED         1
+#define SCOPE_TRIGGERED     2
+#define SCOPE_DONE          3
+
+typedef struct {
+    uint16_t *buffer;
+    uint32_t mask;              /* length - 1, length a power of two */
+    int preTrigger;
+    int type;
+    uint16_t level;
+    int16_t slope;
+
+    /*
+     * state and the counters SCOPE_arm() resets are volatile, so those
+     * writes stay in order and SCOPE_block() never sees SCOPE_ARMED with the
+     * counters of the last capture.
+     */
+    volatile int state;
+    volatile int phase;         /* edge triggers, 1 once on the far side of level */
+    uint16_t last;              /* previous sample, for slope */
+    volatile uint32_t written;  /* samples stored since armed, free running */
+    uint32_t trigger;           /* value of written at the trigger sample */
+    volatile uint32_t remaining; /* samples still to store after the trigger */
+    volatile int forced;
+} scopeCapture;
+
+void SCOPE_init(scopeCapture *, uint16_t *, int, int);
+void SCOPE_setTrigger(scopeCapture *, int, uint16_t, int16_t);
+void SCOPE_arm(scopeCapture *);
+void SCOPE_triggerNow(scopeCapture *);
+void SCOPE_block(scopeCapture *, const uint16_t *, int);
+int SCOPE_frame(const scopeCapture *, uint16_t *);
+void SCOPE_envelope(const scopeCapture *, uint8_t *, uint8_t *, int, int);
+
+void SCOPE_start(scopeCapture *, unsigned int, unsigned int, uint32_t, uint16_t *, uint16_t *, int, int);
+void SCOPE_stop(void);
+
+#endif /* SCOPE_H_ */
@@ -0,0 +1,160 @@
+#include <inttypes.h>
+#include <stdlib.h>
+#include "ADC/adc.h"
+#include "ADC/temperature.h"
+#include "GPTM/GPTM.h"
+
+/* The sequencer given to TEMP_init() */
+static adcModule *tempAdc = 0;
+static int tempSequencer;
+
+/* State of the background log, see TEMP_log() */
+static int16_t *tempLog;
+static int tempLogLength;
+static volatile unsigned long tempLogCount;
+static int tempLogging;
+static volatile int32_t tempLatest;
+static void (*tempUpdate)(int32_t);
+
+/*
+ * Point a sequencer at the temperature sensor. The sequencer is triggered
+ * by the processor, so it can share a module with other work. The module's
+ * sampling rate is left alone, so a running acquisition keeps its rate.
+ *
+ * param adc
+ *          ADC0_MODULE or ADC1_MODULE. ADC1 is a good choice when ADC0 is
+ *          busy with acquisition.
+ *
+ * param ss
+ *          The sample sequencer, 0 - 3
+ *
+ * param average
+ *          Conversions averaged by the hardware per result, 1 - 64 and a
+ *          power of two. The averager is shared by the whole module, see
+ *          ADC_oversample().
+ */
+void TEMP_init(adcModule *adc, int ss, int average) {
+
+    unsigned int channel = ADC_CHANNEL_TEMP;
+
+    ADC_init(adc, ss, 0x00, 0x00, &channel, 1); //keep the module's rate
+    ADC_oversample(adc, average);
+
+    tempAdc = adc;
+    tempSequencer = ss;
+}
+
+/*
+ * Convert a 12 bit sensor reading, p.813:
+ *
+ *      TEMP = 147.5 - (75 * 3.3 * code / 4096)
+ *
+ * so in hundredths, 14750 - 24750 * code / 4096, rounded.
+ */
+int32_t TEMP_centiDegrees(uint32_t code) {
+
+    return 14750 - (int32_t)((24750 * code + 2048) >> 12);
+}
+
+/*
+ * Read the temperature now, in hundredths of a degree. Waits for the
+ * conversion. While TEMP_log() is running the timer owns the sequencer, and
+ * its interrupt would take the result, so the latest logged reading is
+ * returned instead.
+ */
+int32_t TEMP_read(void) {
+
+    uint32_t code;
+
+    if(!tempAdc)
+        exit(EXIT_FAILURE);
+    if(tempLogging)
+        return tempLatest;
+
+    ADC_startSequence(tempAdc, tempSequencer, 0);
+    while(ADC_pollSequence(tempAdc, tempSequencer, &code, 1) < 0);
+
+    return TEMP_centiDegrees(code);
+}
+
+/*
+ * Completion callback of each background reading
+ */
+static void TEMP_logDone(uint32_t code) {
+
+    int32_t centi = TEMP_centiDegrees(code);
+
+    tempLatest = centi;
+    if(tempLog)
+        tempLog[tempLogCount % tempLogLength] = (int16_t)centi;
+    tempLogCount++;
+
+    if(tempUpdate)
+        tempUpdate(centi);
+}
+
+/* Timer 2A tick, starts the next reading */
+static void TEMP_logTick(void) {
+
+    ADC_startSequence(tempAdc, tempSequencer, TEMP_logDone);
+}
+
+/*
+ * Read the temperature in the background every period bus cycles, using
+ * Timer 2A. Nothing runs in the main loop: the timer starts a conversion
+ * and the sequencer interrupt converts and stores the result.
+ *
+ * param period
+ *          Bus clock cycles between readings.
+ *
+ * param pri
+ *          Priority of both the timer and the sequencer interrupt, 0 to 7.
+ *
+ * param log
+ *          Ring of length readings, in hundredths of a degree. Reading n
+ *          goes to log[n % length], see TEMP_logCount(). May be 0 to keep
+ *          only the latest.
+ *
+ * param update
+ *          Called from the interrupt with every reading, e.g. for thermal
+ *          throttling. May be 0.
+ */
+void TEMP_log(uint32_t period, int pri, int16_t *log, int length, void (*update)(int32_t)) {
+
+    if(!tempAdc || (log && length < 1))
+        exit(EXIT_FAILURE);
+
+    tempLog = log;
+    tempLogLength = length;
+    tempLogCount = 0;
+    tempUpdate = update;
+    tempLatest = TEMP_read();
+    tempLogging = 1;
+
+    ADC_enableInterrupt(tempAdc, tempSequencer, pri); //sets the priority used by the callbacks
+    init_timer2A_periodicInterrupt(period, pri, TEMP_logTick);
+}
+
+void TEMP_stopLog(void) {
+
+    stop_timer2A();
+    tempUpdate = 0;
+    tempLogging = 0;
+}
+
+/*
+ * The most recent background reading in hundredths of a degree
+ */
+int32_t TEMP_latest(void) {
+
+    return tempLatest;
+}
+
+/*
+ * Readings logged since TEMP_log(). The newest is at
+ * log[(count - 1) % length].
+ */
+unsigned long TEMP_logCount(void) {
+
+    return tempLogCount;
+}
@@ -0,0 +1,25 @@
+/*
+ * temperature.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: bjh885
+ *
+ * The on-die temperature sensor, read through one sample sequencer. Results
+ * are in hundredths of a degree Celsius and are worked out in integers.
+ */
+
+#ifndef TEMPERATURE_H_
+#define TEMPERATURE_H_
+
+#include <inttypes.h>
+#include "ADC/adc.h"
+
+void TEMP_init(adcModule *, int, int);
+int32_t TEMP_centiDegrees(uint32_t);
+int32_t TEMP_read(void);
+void TEMP_log(uint32_t, int, int16_t *, int, void (*)(int32_t));
+void TEMP_stopLog(void);
+int32_t TEMP_latest(void);
+unsigned long TEMP_logCount(void);
+
+#endif /* TEMPERATURE_H_ */
@@ -0,0 +1,406 @@
+#include <inttypes.h>
+#include "tm4c123gh6pm.h"
+#include "bench.h"
+#include "filter.h"
+#include "fft.h"
+#include "ADC/adc.h"
+#include "UART/uart.h"
+#include "UART/frame.h"
+
+/* Samples per measured call */
+#define BENCH_BLOCK 256
+
+static uint16_t benchAdc[BENCH_BLOCK];
+static int16_t benchIn16[BENCH_BLOCK];
+static int16_t benchOut16[BENCH_BLOCK];
+static int32_t benchIn32[BENCH_BLOCK];
+static int32_t benchOut32[BENCH_BLOCK];
+
+/* Cycles taken by two back to back BENCH_now() calls, taken off every result */
+static uint32_t benchOverhead;
+
+/*
+ * Start the cycle counter and build the test data. TRCENA in DEMCR, which
+ * the header calls NVIC_DBG_INT_R, powers the DWT, then CYCCNTENA starts
+ * the count at the core clock.
+ */
+void BENCH_init(void) {
+
+    uint32_t start;
+    int i;
+
+    NVIC_DBG_INT_R |= 0x01000000; //DEMCR, TRCENA
+    DWT_CYCCNT_R = 0;
+    DWT_CTRL_R |= 0x01; //CYCCNTENA
+
+    start = BENCH_now();
+    benchOverhead = BENCH_now() - start;
+
+    /* A noisy ramp, stepping a simple LCG for the noise */
+    start = 12345;
+    for(i = 0; i < BENCH_BLOCK; i++) {
+        start = start * 1103515245 + 12345;
+        benchAdc[i] = (uint16_t)((i * 16 + (start >> 24)) & 0xFFF);
+    }
+    FILTER_fromAdc(benchAdc, benchIn16, BENCH_BLOCK);
+    for(i = 0; i < BENCH_BLOCK; i++)
+        benchIn32[i] = (int32_t)benchIn16[i] << 16;
+}
+
+static void BENCH_store(benchResult *results, int *count, int max, const char *name,
+                        uint32_t cycles, uint32_t samples) {
+
+    if(*count >= max)
+        return;
+
+    results[*count].name = name;
+    results[*count].cycles = cycles;
+    results[*count].samples = samples;
+    (*count)++;
+}
+
+static void BENCH_record(benchResult *results, int *count, int max, const char *name,
+                         uint32_t start, uint32_t end, uint32_t samples) {
+
+    BENCH_store(results, count, max, name, end - start - benchOverhead, samples);
+}
+
+/* Same low pass sections as the host test, see host/filter_test.c */
+static const int16_t benchBiquad16[10] = {
+    345, 690, 345, 26956, -11953,
+    345, 690, 345, 26956, -11953,
+};
+
+static const int32_t benchBiquad32[10] = {
+    22608532, 45217064, 22608532, 1766585728, -783317024,
+    22608532, 45217064, 22608532, 1766585728, -783317024,
+};
+
+/*
+ * Time each filter on one BENCH_BLOCK sample block. Divide cycles by samples
+ * for cycles per sample. Call BENCH_init() first.
+ *
+ * param results
+ *          Room for max results.
+ *
+ * returns the number of results stored.
+ */
+int BENCH_filters(benchResult *results, int max) {
+
+    static int16_t coeffs16[32], state16[64], history[16], bqState16[8];
+    static int32_t coeffs32[32], state32[64], bqState32[8];
+    firQ15 fir16;
+    firQ31 fir32;
+    biquadQ15 bq16;
+    biquadQ31 bq32;
+    movingAverage ma;
+    uint32_t start;
+    int count = 0;
+    int i;
+
+    for(i = 0; i < 32; i++) {
+        coeffs16[i] = 1024; //32 taps of 1/32
+        coeffs32[i] = 1024L << 16;
+    }
+
+    start = BENCH_now();
+    FILTER_fromAdc(benchAdc, benchOut16, BENCH_BLOCK);
+    BENCH_record(results, &count, max, "FILTER_fromAdc", start, BENCH_now(), BENCH_BLOCK);
+
+    FILTER_initFirQ15(&fir16, coeffs16, state16, 32);
+    start = BENCH_now();
+    FILTER_firQ15(&fir16, benchIn16, benchOut16, BENCH_BLOCK);
+    BENCH_record(results, &count, max, "FILTER_firQ15, 32 taps", start, BENCH_now(), BENCH_BLOCK);
+
+    FILTER_initFirQ31(&fir32, coeffs32, state32, 32);
+    start = BENCH_now();
+    FILTER_firQ31(&fir32, benchIn32, benchOut32, BENCH_BLOCK);
+    BENCH_record(results, &count, max, "FILTER_firQ31, 32 taps", start, BENCH_now(), BENCH_BLOCK);
+
+    FILTER_initBiquadQ15(&bq16, benchBiquad16, bqState16, 2, 1);
+    start = BENCH_now();
+    FILTER_biquadQ15(&bq16, benchIn16, benchOut16, BENCH_BLOCK);
+    BENCH_record(results, &count, max, "FILTER_biquadQ15, 2 stages", start, BENCH_now(), BENCH_BLOCK);
+
+    FILTER_initBiquadQ31(&bq32, benchBiquad32, bqState32, 2, 1);
+    start = BENCH_now();
+    FILTER_biquadQ31(&bq32, benchIn32, benchOut32, BENCH_BLOCK);
+    BENCH_record(results, &count, max, "FILTER_biquadQ31, 2 stages", start, BENCH_now(), BENCH_BLOCK);
+
+    FILTER_initMovingAverage(&ma, history, 16);
+    start = BENCH_now();
+    FILTER_movingAverage(&ma, benchIn16, benchOut16, BENCH_BLOCK);
+    BENCH_record(results, &count, max, "FILTER_movingAverage, 16", start, BENCH_now(), BENCH_BLOCK);
+
+    return count;
+}
+
+/*
+ * Time FFT_q15() at every size, then FFT_magnitude() and a goertzel window
+ * of 205 samples, the usual DTMF length at 8kHz. cycles is per block here.
+ * Call BENCH_init() first.
+ *
+ * param results
+ *          Room for max results.
+ *
+ * returns the number of results stored.
+ */
+int BENCH_fft(benchResult *results, int max) {
+
+    static const char *names[] = {"FFT_q15, 64", "FFT_q15, 128", "FFT_q15, 256",
+                                  "FFT_q15, 512", "FFT_q15, 1024"};
+    static int16_t data[2 * FFT_MAX_SIZE];
+    static uint16_t adc[FFT_MAX_SIZE];
+    static uint16_t magnitude[FFT_MAX_SIZE / 2];
+    goertzel g;
+    uint32_t power;
+    uint32_t start;
+    int count = 0;
+    int n, i;
+
+    for(i = 0; i < FFT_MAX_SIZE; i++)
+        adc[i] = benchAdc[i % BENCH_BLOCK];
+
+    for(n = FFT_MIN_SIZE, i = 0; n <= FFT_MAX_SIZE; n *= 2, i++) {
+        FFT_fromAdc(adc, data, n);
+        start = BENCH_now();
+        FFT_q15(data, n);
+        BENCH_record(results, &count, max, names[i], start, BENCH_now(), n);
+    }
+
+    start = BENCH_now();
+    FFT_magnitude(data, magnitude, FFT_MAX_SIZE);
+    BENCH_record(results, &count, max, "FFT_magnitude, 1024", start, BENCH_now(), FFT_MAX_SIZE / 2);
+
+    GOERTZEL_init(&g, 697, 8000, 205);
+    start = BENCH_now();
+    GOERTZEL_block(&g, adc, 205, &power);
+    BENCH_record(results, &count, max, "GOERTZEL_block, 205", start, BENCH_now(), 205);
+
+    return count;
+}
+
+/* Samples per acquisition block */
+#define BENCH_ACQ_BLOCK 256
+
+/*
+ * Exception entry and exit on the M4, 12 cycles each with no FPU context.
+ * A handler cannot see them, so they are added to each call it times.
+ */
+#define BENCH_EXCEPTION 24
+
+static uint16_t benchAcqA[BENCH_ACQ_BLOCK];
+static uint16_t benchAcqB[BENCH_ACQ_BLOCK];
+
+/* The acquisition handler being measured, and what it has cost so far */
+static void (*benchAcqHandler)(void);
+static volatile unsigned long benchAcqStart;
+static volatile unsigned long benchAcqTarget;
+static volatile uint32_t benchAcqFirst;
+static volatile uint32_t benchAcqLast;
+static volatile uint32_t benchAcqIsr;
+static volatile int benchAcqDone;
+
+/*
+ * Wraps the ADC0 SS3 acquisition handler. Timing starts at the end of the
+ * first block, so start up is left out. The acquisition is stopped from
+ * here once enough blocks are in, which also ends a run where the per
+ * sample interrupts leave the main loop no time at all.
+ */
+static void BENCH_acquireHandler(void) {
+
+    unsigned long blocks, overruns;
+    uint32_t start = BENCH_now();
+    uint32_t end;
+
+    benchAcqHandler();
+    end = BENCH_now();
+
+    ADC0_acquireStats(&blocks, &overruns);
+    if(!benchAcqStart) {
+        if(blocks) {
+            benchAcqStart = blocks;
+            benchAcqFirst = end;
+        }
+        return;
+    }
+
+    benchAcqIsr += end - start - benchOverhead + BENCH_EXCEPTION;
+    if(blocks - benchAcqStart >= benchAcqTarget) {
+        benchAcqLast = end;
+        benchAcqTarget = blocks - benchAcqStart;
+        ADC0_stopAcquire();
+        benchAcqDone = 1;
+    }
+}
+
+static void BENCH_acquireRun(benchResult *results, int *count, int max, const char *wall,
+                             const char *isr, unsigned long blocks) {
+
+    uint32_t samples;
+
+    benchAcqHandler = ADC_handlerOf(ADC0_MODULE, 3);
+    benchAcqStart = 0;
+    benchAcqTarget = blocks;
+    benchAcqIsr = 0;
+    benchAcqDone = 0;
+    ADC_attachHandler(ADC0_MODULE, 3, BENCH_acquireHandler);
+
+    while(!benchAcqDone);
+
+    samples = benchAcqTarget * BENCH_ACQ_BLOCK;
+    BENCH_store(results, count, max, wall, benchAcqLast - benchAcqFirst, samples);
+    BENCH_store(results, count, max, isr, benchAcqIsr, samples);
+}
+
+/*
+ * Sustained rate and CPU load of ADC0 acquisition, first with an interrupt
+ * per sample (init_adc0_acquire()), then with uDMA (init_adc0_acquireDMA()),
+ * in BENCH_ACQ_BLOCK sample blocks. Each gives two results over the same
+ * samples: the wall time, so samples * core clock / cycles is the sample
+ * rate, and the time spent in the SS3 handler, so ISR cycles / wall cycles
+ * is its share of the CPU. Blocks lost to overruns are not counted, so the
+ * rate is what the application actually received. Uses ADC0 SS3 and Timer
+ * 1A. Call BENCH_init() first, with interrupts enabled.
+ *
+ * param sampleSelect
+ *          0x01 - 0x09 corresponds to AIN0 - AIN9
+ *
+ * param period
+ *          Bus clock cycles between samples, e.g. 80 for 1Msps at 80MHz.
+ *
+ * param blocks
+ *          Blocks to time in each mode. Keep the run under 2^32 cycles.
+ *
+ * returns the number of results stored.
+ */
+int BENCH_acquire(benchResult *results, int max, unsigned int sampleSelect, uint32_t period,
+                  unsigned long blocks) {
+
+    int count = 0;
+
+    init_adc0_acquire(0x07, sampleSelect, period, benchAcqA, benchAcqB, BENCH_ACQ_BLOCK, 0, 0);
+    BENCH_acquireRun(results, &count, max, "acquire per sample, wall", "acquire per sample, ISR", blocks);
+
+    init_adc0_acquireDMA(0x07, sampleSelect, period, benchAcqA, benchAcqB, BENCH_ACQ_BLOCK, 0, 0);
+    BENCH_acquireRun(results, &count, max, "acquire DMA, wall", "acquire DMA, ISR", blocks);
+
+    return count;
+}
+
+/*
+ * Spin until busy() returns 0, and work out how much of that time went to
+ * interrupts. Every pass of the loop does the same work, so anything above
+ * the quickest pass was taken by a handler.
+ *
+ * param wall
+ *          Set to the cycles spent in the loop.
+ *
+ * returns the cycles taken by interrupts.
+ */
+static uint32_t BENCH_stolen(int (*busy)(void), uint32_t *wall) {
+
+    uint32_t start, last, now;
+    uint32_t quickest = 0xFFFFFFFF;
+    uint32_t passes = 0;
+
+    start = BENCH_now();
+    last = start;
+    while(busy()) {
+        now = BENCH_now();
+        if(now - last < quickest)
+            quickest = now - last;
+        last = now;
+        passes++;
+    }
+
+    *wall = last - start;
+    return passes ? *wall - passes * quickest : 0;
+}
+
+/* Anything left to go out of UART1, p.861 TXFE clear or BUSY set */
+static int BENCH_uart1Busy(void) {
+
+    return UART1_sendBufferBusy() || (UART1_FR_R & 0x88) != 0x80;
+}
+
+static int BENCH_uart1DmaBusy(void) {
+
+    return UART1_sendBufferBusy();
+}
+
+/*
+ * CPU cycles to send 1KB out of UART1, once a byte at a time with
+ * UART1_send() and once with UART1_sendBuffer(). Time spent waiting for
+ * TXFF in the byte path counts, since the CPU can do nothing else. For the
+ * uDMA path only the call and the interrupts that chain and finish the
+ * transfer count, and the line time is given too for comparison. Call
+ * UART1_init() and BENCH_init() first, with interrupts enabled.
+ *
+ * param results
+ *          Room for max results.
+ *
+ * returns the number of results stored.
+ */
+int BENCH_uart1(benchResult *results, int max) {
+
+    static uint8_t text[1024];
+    uint32_t start, end, wall, stolen;
+    int count = 0;
+    int i;
+
+    for(i = 0; i < 1024; i++)
+        text[i] = (uint8_t)((i % 64 == 63) ? '\n' : ' ' + i % 64);
+
+    BENCH_stolen(BENCH_uart1Busy, &wall); //start with an empty FIFO
+
+    start = BENCH_now();
+    for(i = 0; i < 1024; i++)
+        UART1_send(text[i]);
+    end = BENCH_now();
+    stolen = BENCH_stolen(BENCH_uart1Busy, &wall);
+    BENCH_store(results, &count, max, "UART1_send, 1KB", end - start - benchOverhead + stolen, 1024);
+
+    start = BENCH_now();
+    UART1_sendBuffer(text, 1024, 0);
+    end = BENCH_now();
+    stolen = BENCH_stolen(BENCH_uart1DmaBusy, &wall);
+    stolen += BENCH_stolen(BENCH_uart1Busy, &wall);
+    BENCH_store(results, &count, max, "UART1_sendBuffer, 1KB", end - start - benchOverhead + stolen, 1024);
+    BENCH_record(results, &count, max, "UART1 line time, 1KB", start, BENCH_now(), 1024);
+
+    return count;
+}
+
+/*
+ * Encode cost of a full frame, FRAME_MAX_PAYLOAD bytes of ADC samples, and
+ * of its CRC and COBS parts alone. samples counts payload bytes, so
+ * cycles / samples is cycles per byte. host/frame_rate.c gives the payload
+ * rate this leaves on the line. Call BENCH_init() first.
+ *
+ * param results
+ *          Room for max results.
+ *
+ * returns the number of results stored.
+ */
+int BENCH_frame(benchResult *results, int max) {
+
+    static uint8_t line[FRAME_ENCODED_SIZE(FRAME_MAX_PAYLOAD)];
+    const uint8_t *payload = (const uint8_t *)benchAdc;
+    uint32_t start;
+    int count = 0;
+
+    start = BENCH_now();
+    FRAME_encode(0, payload, FRAME_MAX_PAYLOAD, line);
+    BENCH_record(results, &count, max, "FRAME_encode, 250 bytes", start, BENCH_now(), FRAME_MAX_PAYLOAD);
+
+    start = BENCH_now();
+    FRAME_crc16(FRAME_CRC_INIT, payload, FRAME_MAX_PAYLOAD);
+    BENCH_record(results, &count, max, "FRAME_crc16, 250 bytes", start, BENCH_now(), FRAME_MAX_PAYLOAD);
+
+    start = BENCH_now();
+    FRAME_cobsEncode(payload, FRAME_MAX_PAYLOAD, line);
+    BENCH_record(results, &count, max, "FRAME_cobsEncode, 250 bytes", start, BENCH_now(), FRAME_MAX_PAYLOAD);
+
+    return count;
+}
@@ -0,0 +1,42 @@
+/*
+ * bench.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: bjh885
+ *
+ * Cycle counts for the DSP routines and the streaming paths of the drivers,
+ * taken on the target with the DWT cycle counter around each call. Each
+ * routine runs once on a block of test data that is already in RAM, with
+ * interrupts left as they are, so run it from an idle main loop for steady
+ * numbers.
+ */
+
+#ifndef BENCH_H_
+#define BENCH_H_
+
+#include <inttypes.h>
+
+#define DWT_CTRL_R      (*((volatile unsigned long *)0xE0001000)) // ARMv7-M ARM C1.8.7, DWT control
+#define DWT_CYCCNT_R    (*((volatile unsigned long *)0xE0001004)) // cycle counter
+
+/* One measured call */
+typedef struct {
+    const char *name;
+    uint32_t cycles;        /* for the whole call */
+    uint32_t samples;       /* samples the call processed */
+} benchResult;
+
+/* Cycles since BENCH_init(). Wraps every 2^32 cycles, so take differences */
+static inline uint32_t BENCH_now(void) {
+
+    return DWT_CYCCNT_R;
+}
+
+void BENCH_init(void);
+int BENCH_filters(benchResult *, int);
+int BENCH_fft(benchResult *, int);
+int BENCH_acquire(benchResult *, int, unsigned int, uint32_t, unsigned long);
+int BENCH_uart1(benchResult *, int);
+int BENCH_frame(benchResult *, int);
+
+#endif /* BENCH_H_ */
@@ -0,0 +1,286 @@
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include "codec.h"
+
+/* Standard IMA-ADPCM tables */
+static const int8_t adpcmIndexStep[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+static const int16_t adpcmStepSize[89] = {
+        7,     8,     9,    10,    11,    12,    13,    14,    16,    17,
+       19,    21,    23,    25,    28,    31,    34,    37,    41,    45,
+       50,    55,    60,    66,    73,    80,    88,    97,   107,   118,
+      130,   143,   157,   173,   190,   209,   230,   253,   279,   307,
+      337,   371,   408,   449,   494,   544,   598,   658,   724,   796,
+      876,   963,  1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,
+     2272,  2499,  2749,  3024,  3327,  3660,  4026,  4428,  4871,  5358,
+     5894,  6484,  7132,  7845,  8630,  9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+/*
+ * Apply one 4 bit code to the state, the same way on both sides
+ */
+static void ADPCM_step(adpcmState *state, int code) {
+
+    int step = adpcmStepSize[state->index];
+    int32_t diff = step >> 3;
+
+    if(code & 4)
+        diff += step;
+    if(code & 2)
+        diff += step >> 1;
+    if(code & 1)
+        diff += step >> 2;
+    state->predictor += (code & 8) ? -diff : diff;
+
+    if(state->predictor > 32767)
+        state->predictor = 32767;
+    else if(state->predictor < -32768)
+        state->predictor = -32768;
+
+    state->index += adpcmIndexStep[code];
+    if(state->index < 0)
+        state->index = 0;
+    else if(state->index > 88)
+        state->index = 88;
+}
+
+/* 12 bit ADC result to Q15 around mid scale and back */
+static int32_t ADPCM_toQ15(uint16_t x) {
+
+    return ((int32_t)x - 2048) << 4;
+}
+
+static uint16_t ADPCM_fromQ15(int32_t q) {
+
+    int32_t x = ((q + 8) >> 4) + 2048;
+
+    return (uint16_t)(x < 0 ? 0 : (x > 4095 ? 4095 : x));
+}
+
+void ADPCM_init(adpcmState *state) {
+
+    state->predictor = 0;
+    state->index = 0;
+}
+
+/*
+ * Encode a block of raw 12 bit results. The state carries over, so a stream
+ * of blocks costs no more than one long block, but the header makes every
+ * block decodable without the ones before it.
+ *
+ * param out
+ *          Room for ADPCM_BLOCK_SIZE(n) bytes.
+ *
+ * returns the number of bytes written.
+ */
+size_t ADPCM_encode(adpcmState *state, const uint16_t *in, int n, uint8_t *out) {
+
+    uint8_t *p = out + 4;
+    int32_t diff;
+    int step, code;
+    int i;
+
+    out[0] = (uint8_t)state->predictor;
+    out[1] = (uint8_t)(state->predictor >> 8);
+    out[2] = (uint8_t)state->index;
+    out[3] = 0;
+
+    for(i = 0; i < n; i++) {
+        /* Successive approximation of the difference in units of step / 4 */
+        diff = ADPCM_toQ15(in[i]) - state->predictor;
+        step = adpcmStepSize[state->index];
+        code = 0;
+        if(diff < 0) {
+            code = 8;
+            diff = -diff;
+        }
+        if(diff >= step) {
+            code |= 4;
+            diff -= step;
+        }
+        if(diff >= step >> 1) {
+            code |= 2;
+            diff -= step >> 1;
+        }
+        if(diff >= step >> 2)
+            code |= 1;
+
+        ADPCM_step(state, code);
+
+        if(i & 1)
+            *p++ |= (uint8_t)(code << 4);
+        else
+            *p = (uint8_t)code;
+    }
+
+    return ADPCM_BLOCK_SIZE(n);
+}
+
+/*
+ * Decode one block written by ADPCM_encode()
+ *
+ * param n
+ *          The number of samples the block was encoded from.
+ *
+ * returns n.
+ */
+int ADPCM_decode(const uint8_t *in, int n, uint16_t *out) {
+
+    adpcmState state;
+    const uint8_t *p = in + 4;
+    int i;
+
+    state.predictor = (int16_t)(in[0] | (in[1] << 8));
+    state.index = in[2] > 88 ? 88 : in[2];
+
+    for(i = 0; i < n; i++) {
+        ADPCM_step(&state, (i & 1) ? (*p++ >> 4) : (*p & 0x0F));
+        out[i] = ADPCM_fromQ15(state.predictor);
+    }
+
+    return n;
+}
+
+/*
+ * param storage, bytes
+ *          The RAM to keep the history in.
+ *
+ * param blockSamples
+ *          Samples in every block given to ADPCM_historyAdd(), e.g. the
+ *          acquisition block size.
+ */
+void ADPCM_historyInit(adpcmHistory *history, uint8_t *storage, size_t bytes, int blockSamples) {
+
+    if(blockSamples < 1)
+        exit(EXIT_FAILURE);
+
+    history->storage = storage;
+    history->blockSamples = blockSamples;
+    history->slotSize = ADPCM_BLOCK_SIZE(blockSamples);
+    history->slots = (int)(bytes / history->slotSize);
+    history->head = 0;
+    history->used = 0;
+    ADPCM_init(&history->state);
+
+    if(history->slots < 1)
+        exit(EXIT_FAILURE);
+}
+
+/*
+ * Compress one block into the ring, e.g. from an acquisition blockDone
+ * callback.
+ */
+void ADPCM_historyAdd(adpcmHistory *history, const uint16_t *block) {
+
+    ADPCM_encode(&history->state, block, history->blockSamples,
+                 history->storage + history->head * history->slotSize);
+
+    if(++history->head == history->slots)
+        history->head = 0;
+    if(history->used < history->slots)
+        history->used++;
+}
+
+/*
+ * Decode the history, oldest sample first. Call with acquisition stopped or
+ * from the same interrupt that adds to it.
+ *
+ * param max
+ *          Room in out. Only the newest blocks that fit are decoded.
+ *
+ * returns the number of samples written.
+ */
+int ADPCM_historyRead(const adpcmHistory *history, uint16_t *out, int max) {
+
+    int blocks = history->used;
+    int slot;
+    int n = 0;
+
+    if(blocks > max / history->blockSamples)
+        blocks = max / history->blockSamples;
+
+    slot = history->head - blocks;
+    if(slot < 0)
+        slot += history->slots;
+
+    while(blocks--) {
+        n += ADPCM_decode(history->storage + slot * history->slotSize,
+                          history->blockSamples, out + n);
+        if(++slot == history->slots)
+            slot = 0;
+    }
+
+    return n;
+}
+
+/*
+ * Lossless delta coding. The first sample is stored as is, every later one
+ * as the difference from the one before. Differences are zig-zag mapped
+ * (0, -1, 1, -2 ... to 0, 1, 2, 3 ...) and written 7 bits per byte, low
+ * first, with the top bit set on all but the last byte. Deltas of -64 to 63
+ * take one byte, any other 12 bit delta two.
+ *
+ * param out
+ *          Room for DELTA_MAX_SIZE(n) bytes.
+ *
+ * returns the number of bytes written.
+ */
+size_t DELTA_encode(const uint16_t *in, int n, uint8_t *out) {
+
+    uint8_t *p = out;
+    int32_t previous = 0;
+    int32_t delta;
+    uint32_t zigzag;
+    int i;
+
+    for(i = 0; i < n; i++) {
+        delta = (int32_t)in[i] - previous;
+        previous = in[i];
+        zigzag = (uint32_t)((delta << 1) ^ (delta >> 31));
+        while(zigzag >= 0x80) {
+            *p++ = (uint8_t)(zigzag | 0x80);
+            zigzag >>= 7;
+        }
+        *p++ = (uint8_t)zigzag;
+    }
+
+    return (size_t)(p - out);
+}
+
+/*
+ * Decode len bytes written by DELTA_encode()
+ *
+ * returns the number of samples written, or -1 if the data is cut short or
+ * there are more than max samples.
+ */
+int DELTA_decode(const uint8_t *in, size_t len, uint16_t *out, int max) {
+
+    const uint8_t *end = in + len;
+    int32_t previous = 0;
+    uint32_t zigzag;
+    int shift;
+    int n = 0;
+
+    while(in < end) {
+        zigzag = 0;
+        shift = 0;
+        do {
+            if(in == end || shift > 28)
+                return -1;
+            zigzag |= (uint32_t)(*in & 0x7F) << shift;
+            shift += 7;
+        } while(*in++ & 0x80);
+
+        if(n == max)
+            return -1;
+        previous += (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1);
+        out[n++] = (uint16_t)previous;
+    }
+
+    return n;
+}
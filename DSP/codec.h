@@ -0,0 +1,58 @@
+/*
+ * codec.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: bjh885
+ *
+ * Compression of ADC sample history so more of it fits in RAM. IMA-ADPCM
+ * stores every 12 bit sample in 4 bits, 4x smaller than a uint16_t, with a
+ * small loss. Delta coding with zig-zag varints is lossless and suits slow
+ * signals, where most deltas fit in one byte. Both work block by block,
+ * every block decodes on its own, and nothing here touches the hardware so
+ * the same file decodes dumps on the host.
+ */
+
+#ifndef CODEC_H_
+#define CODEC_H_
+
+#include <inttypes.h>
+#include <stddef.h>
+
+/* Bytes for an ADPCM block of n samples: a 4 byte header, then 2 per byte */
+#define ADPCM_BLOCK_SIZE(n) (4 + ((n) + 1) / 2)
+
+/* Most bytes DELTA_encode() can need for n samples */
+#define DELTA_MAX_SIZE(n) (2 * (n))
+
+/* Encoder state carried from one block to the next */
+typedef struct {
+    int32_t predictor;      /* last reconstructed sample, Q15 */
+    int index;              /* into the step table, 0 - 88 */
+} adpcmState;
+
+/*
+ * Ring of encoded blocks. When full, the oldest block is overwritten, so it
+ * always holds the most recent history that fits.
+ */
+typedef struct {
+    uint8_t *storage;
+    int blockSamples;
+    int slotSize;           /* ADPCM_BLOCK_SIZE(blockSamples) */
+    int slots;
+    int head;               /* next slot to write */
+    int used;
+    adpcmState state;
+} adpcmHistory;
+
+void ADPCM_init(adpcmState *);
+size_t ADPCM_encode(adpcmState *, const uint16_t *, int, uint8_t *);
+int ADPCM_decode(const uint8_t *, int, uint16_t *);
+
+void ADPCM_historyInit(adpcmHistory *, uint8_t *, size_t, int);
+void ADPCM_historyAdd(adpcmHistory *, const uint16_t *);
+int ADPCM_historyRead(const adpcmHistory *, uint16_t *, int);
+
+size_t DELTA_encode(const uint16_t *, int, uint8_t *);
+int DELTA_decode(const uint8_t *, size_t, uint16_t *, int);
+
+#endif /* CODEC_H_ */
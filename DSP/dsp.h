@@ -0,0 +1,90 @@
+/*
+ * dsp.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: bjh885
+ *
+ * Fixed point helpers shared by the filters, the FFT and the statistics. Q15 values are
+ * int16_t in [-1, 1), Q31 values int32_t in [-1, 1). The dual 16-bit
+ * multiply-accumulates map onto the Cortex-M4 SMLAD/SMLALD instructions
+ * when the compiler has the ACLE intrinsics, and onto plain C otherwise,
+ * which is also what a host build uses as its reference.
+ */
+
+#ifndef DSP_H_
+#define DSP_H_
+
+#include <inttypes.h>
+#include <string.h>
+
+#if defined(__ARM_FEATURE_DSP)
+#include <arm_acle.h>
+#define DSP_SMLAD(x, y, acc)    __smlad((x), (y), (acc))
+#define DSP_SMLALD(x, y, acc)   __smlald((x), (y), (acc))
+#else
+/* acc + x.lo * y.lo + x.hi * y.hi */
+static inline int32_t DSP_SMLAD(uint32_t x, uint32_t y, int32_t acc) {
+
+    return acc + (int32_t)(int16_t)x * (int16_t)y +
+                 (int32_t)(int16_t)(x >> 16) * (int16_t)(y >> 16);
+}
+
+static inline int64_t DSP_SMLALD(uint32_t x, uint32_t y, int64_t acc) {
+
+    return acc + (int32_t)(int16_t)x * (int16_t)y +
+                 (int32_t)(int16_t)(x >> 16) * (int16_t)(y >> 16);
+}
+#endif
+
+/* Two neighbouring Q15 values as one word, low half first. Any alignment */
+static inline uint32_t DSP_pair(const int16_t *p) {
+
+    uint32_t word;
+    memcpy(&word, p, 4);
+    return word;
+}
+
+static inline int16_t DSP_saturate16(int64_t x) {
+
+    if(x > 32767)
+        return 32767;
+    if(x < -32768)
+        return -32768;
+    return (int16_t)x;
+}
+
+static inline int32_t DSP_saturate32(int64_t x) {
+
+    if(x > INT32_MAX)
+        return INT32_MAX;
+    if(x < INT32_MIN)
+        return INT32_MIN;
+    return (int32_t)x;
+}
+
+/*
+ * Integer square root, rounded down. One result bit per pass.
+ */
+static inline uint32_t DSP_sqrt(uint64_t x) {
+
+    uint64_t root = 0;
+    uint64_t bit = 1ULL << 62;
+
+    while(bit > x)
+        bit >>= 2;
+
+    while(bit) {
+        if(x >= root + bit) {
+            x -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return (uint32_t)root;
+}
+
+#endif /* DSP_H_ */
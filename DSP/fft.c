@@ -0,0 +1,271 @@
+#include <inttypes.h>
+#include <stdlib.h>
+#include "fft.h"
+
+/*
+ * sin(2 pi k / 1024) in Q15 for k = 0 .. 767. cos is the same table a
+ * quarter turn (256) further on. Every supported size divides 1024, so the
+ * twiddle W_N^k is entry k * 1024 / N.
+ */
+static const int16_t fftSine[768] = {
+         0,    201,    402,    603,    804,   1005,   1206,   1407,   1608,   1809,   2009,   2210,
+      2411,   2611,   2811,   3012,   3212,   3412,   3612,   3812,   4011,   4211,   4410,   4609,
+      4808,   5007,   5205,   5404,   5602,   5800,   5998,   6195,   6393,   6590,   6787,   6983,
+      7180,   7376,   7571,   7767,   7962,   8157,   8351,   8546,   8740,   8933,   9127,   9319,
+      9512,   9704,   9896,  10088,  10279,  10469,  10660,  10850,  11039,  11228,  11417,  11605,
+     11793,  11980,  12167,  12354,  12540,  12725,  12910,  13095,  13279,  13463,  13646,  13828,
+     14010,  14192,  14373,  14553,  14733,  14912,  15091,  15269,  15447,  15624,  15800,  15976,
+     16151,  16326,  16500,  16673,  16846,  17018,  17190,  17361,  17531,  17700,  17869,  18037,
+     18205,  18372,  18538,  18703,  18868,  19032,  19195,  19358,  19520,  19681,  19841,  20001,
+     20160,  20318,  20475,  20632,  20788,  20943,  21097,  21251,  21403,  21555,  21706,  21856,
+     22006,  22154,  22302,  22449,  22595,  22740,  22884,  23028,  23170,  23312,  23453,  23593,
+     23732,  23870,  24008,  24144,  24279,  24414,  24548,  24680,  24812,  24943,  25073,  25202,
+     25330,  25457,  25583,  25708,  25833,  25956,  26078,  26199,  26320,  26439,  26557,  26674,
+     26791,  26906,  27020,  27133,  27246,  27357,  27467,  27576,  27684,  27791,  27897,  28002,
+     28106,  28209,  28311,  28411,  28511,  28610,  28707,  28803,  28899,  28993,  29086,  29178,
+     29269,  29359,  29448,  29535,  29622,  29707,  29792,  29875,  29957,  30038,  30118,  30196,
+     30274,  30350,  30425,  30499,  30572,  30644,  30715,  30784,  30853,  30920,  30986,  31050,
+     31114,  31177,  31238,  31298,  31357,  31415,  31471,  31527,  31581,  31634,  31686,  31737,
+     31786,  31834,  31881,  31927,  31972,  32015,  32058,  32099,  32138,  32177,  32214,  32251,
+     32286,  32319,  32352,  32383,  32413,  32442,  32470,  32496,  32522,  32546,  32568,  32590,
+     32610,  32629,  32647,  32664,  32679,  32693,  32706,  32718,  32729,  32738,  32746,  32753,
+     32758,  32762,  32766,  32767,  32767,  32767,  32766,  32762,  32758,  32753,  32746,  32738,
+     32729,  32718,  32706,  32693,  32679,  32664,  32647,  32629,  32610,  32590,  32568,  32546,
+     32522,  32496,  32470,  32442,  32413,  32383,  32352,  32319,  32286,  32251,  32214,  32177,
+     32138,  32099,  32058,  32015,  31972,  31927,  31881,  31834,  31786,  31737,  31686,  31634,
+     31581,  31527,  31471,  31415,  31357,  31298,  31238,  31177,  31114,  31050,  30986,  30920,
+     30853,  30784,  30715,  30644,  30572,  30499,  30425,  30350,  30274,  30196,  30118,  30038,
+     29957,  29875,  29792,  29707,  29622,  29535,  29448,  29359,  29269,  29178,  29086,  28993,
+     28899,  28803,  28707,  28610,  28511,  28411,  28311,  28209,  28106,  28002,  27897,  27791,
+     27684,  27576,  27467,  27357,  27246,  27133,  27020,  26906,  26791,  26674,  26557,  26439,
+     26320,  26199,  26078,  25956,  25833,  25708,  25583,  25457,  25330,  25202,  25073,  24943,
+     24812,  24680,  24548,  24414,  24279,  24144,  24008,  23870,  23732,  23593,  23453,  23312,
+     23170,  23028,  22884,  22740,  22595,  22449,  22302,  22154,  22006,  21856,  21706,  21555,
+     21403,  21251,  21097,  20943,  20788,  20632,  20475,  20318,  20160,  20001,  19841,  19681,
+     19520,  19358,  19195,  19032,  18868,  18703,  18538,  18372,  18205,  18037,  17869,  17700,
+     17531,  17361,  17190,  17018,  16846,  16673,  16500,  16326,  16151,  15976,  15800,  15624,
+     15447,  15269,  15091,  14912,  14733,  14553,  14373,  14192,  14010,  13828,  13646,  13463,
+     13279,  13095,  12910,  12725,  12540,  12354,  12167,  11980,  11793,  11605,  11417,  11228,
+     11039,  10850,  10660,  10469,  10279,  10088,   9896,   9704,   9512,   9319,   9127,   8933,
+      8740,   8546,   8351,   8157,   7962,   7767,   7571,   7376,   7180,   6983,   6787,   6590,
+      6393,   6195,   5998,   5800,   5602,   5404,   5205,   5007,   4808,   4609,   4410,   4211,
+      4011,   3812,   3612,   3412,   3212,   3012,   2811,   2611,   2411,   2210,   2009,   1809,
+      1608,   1407,   1206,   1005,    804,    603,    402,    201,      0,   -201,   -402,   -603,
+      -804,  -1005,  -1206,  -1407,  -1608,  -1809,  -2009,  -2210,  -2411,  -2611,  -2811,  -3012,
+     -3212,  -3412,  -3612,  -3812,  -4011,  -4211,  -4410,  -4609,  -4808,  -5007,  -5205,  -5404,
+     -5602,  -5800,  -5998,  -6195,  -6393,  -6590,  -6787,  -6983,  -7180,  -7376,  -7571,  -7767,
+     -7962,  -8157,  -8351,  -8546,  -8740,  -8933,  -9127,  -9319,  -9512,  -9704,  -9896, -10088,
+    -10279, -10469, -10660, -10850, -11039, -11228, -11417, -11605, -11793, -11980, -12167, -12354,
+    -12540, -12725, -12910, -13095, -13279, -13463, -13646, -13828, -14010, -14192, -14373, -14553,
+    -14733, -14912, -15091, -15269, -15447, -15624, -15800, -15976, -16151, -16326, -16500, -16673,
+    -16846, -17018, -17190, -17361, -17531, -17700, -17869, -18037, -18205, -18372, -18538, -18703,
+    -18868, -19032, -19195, -19358, -19520, -19681, -19841, -20001, -20160, -20318, -20475, -20632,
+    -20788, -20943, -21097, -21251, -21403, -21555, -21706, -21856, -22006, -22154, -22302, -22449,
+    -22595, -22740, -22884, -23028, -23170, -23312, -23453, -23593, -23732, -23870, -24008, -24144,
+    -24279, -24414, -24548, -24680, -24812, -24943, -25073, -25202, -25330, -25457, -25583, -25708,
+    -25833, -25956, -26078, -26199, -26320, -26439, -26557, -26674, -26791, -26906, -27020, -27133,
+    -27246, -27357, -27467, -27576, -27684, -27791, -27897, -28002, -28106, -28209, -28311, -28411,
+    -28511, -28610, -28707, -28803, -28899, -28993, -29086, -29178, -29269, -29359, -29448, -29535,
+    -29622, -29707, -29792, -29875, -29957, -30038, -30118, -30196, -30274, -30350, -30425, -30499,
+    -30572, -30644, -30715, -30784, -30853, -30920, -30986, -31050, -31114, -31177, -31238, -31298,
+    -31357, -31415, -31471, -31527, -31581, -31634, -31686, -31737, -31786, -31834, -31881, -31927,
+    -31972, -32015, -32058, -32099, -32138, -32177, -32214, -32251, -32286, -32319, -32352, -32383,
+    -32413, -32442, -32470, -32496, -32522, -32546, -32568, -32590, -32610, -32629, -32647, -32664,
+    -32679, -32693, -32706, -32718, -32729, -32738, -32746, -32753, -32758, -32762, -32766, -32767
+};
+
+/* x = x * W, where W = cos - i sin of table entry k */
+#define FFT_TWIDDLE(re, im, k) do { \
+        int32_t wc = fftSine[(k) + 256]; \
+        int32_t ws = fftSine[(k)]; \
+        int32_t t = ((re) * wc + (im) * ws + 0x4000) >> 15; \
+        (im) = ((im) * wc - (re) * ws + 0x4000) >> 15; \
+        (re) = t; \
+    } while(0)
+
+/*
+ * Put the input into bit reversed order so the butterflies can work in
+ * place from the smallest transforms up.
+ */
+static void FFT_bitReverse(int16_t *data, int n) {
+
+    int i, j = 0, bit;
+    int16_t t;
+
+    for(i = 1; i < n; i++) {
+        for(bit = n >> 1; j & bit; bit >>= 1)
+            j ^= bit;
+        j |= bit;
+        if(i < j) {
+            t = data[2 * i]; data[2 * i] = data[2 * j]; data[2 * j] = t;
+            t = data[2 * i + 1]; data[2 * i + 1] = data[2 * j + 1]; data[2 * j + 1] = t;
+        }
+    }
+}
+
+/*
+ * Load a block of raw 12 bit ADC results as complex Q15 with no imaginary
+ * part, centred on mid scale.
+ *
+ * param data
+ *          Room for 2 * n values, re and im interleaved.
+ */
+void FFT_fromAdc(const uint16_t *in, int16_t *data, int n) {
+
+    int i;
+
+    for(i = 0; i < n; i++) {
+        data[2 * i] = (int16_t)((((uint32_t)in[i] << 4) & 0xFFF0) ^ 0x8000);
+        data[2 * i + 1] = 0;
+    }
+}
+
+/*
+ * Forward FFT in place. Every radix-2 step halves the values so nothing can
+ * overflow, which makes the result the DFT divided by n.
+ *
+ * param data
+ *          n complex Q15 values, re and im interleaved.
+ *
+ * param n
+ *          64, 128, 256, 512 or 1024
+ */
+void FFT_q15(int16_t *data, int n) {
+
+    int32_t ar, ai, br, bi, cr, ci, dr, di, tr, ti;
+    int log2n = 0;
+    int m, j, base, step;
+    int16_t *a, *b, *c, *d;
+
+    if(n < FFT_MIN_SIZE || n > FFT_MAX_SIZE || (n & (n - 1)))
+        exit(EXIT_FAILURE);
+    while((1 << log2n) < n)
+        log2n++;
+
+    FFT_bitReverse(data, n);
+
+    /* Odd number of radix-2 steps, do one on its own so the rest pair up */
+    m = 1;
+    if(log2n & 1) {
+        for(a = data; a < data + 2 * n; a += 4) {
+            ar = a[0]; ai = a[1]; br = a[2]; bi = a[3];
+            a[0] = (ar + br) >> 1; a[1] = (ai + bi) >> 1;
+            a[2] = (ar - br) >> 1; a[3] = (ai - bi) >> 1;
+        }
+        m = 2;
+    }
+
+    /*
+     * Each pass turns transforms of m points into transforms of 4m points,
+     * i.e. two radix-2 steps with one trip through memory.
+     */
+    for(; m < n; m *= 4) {
+        step = FFT_MAX_SIZE / (4 * m);
+        for(j = 0; j < m; j++) {
+            for(base = 0; base < n; base += 4 * m) {
+                a = data + 2 * (base + j);
+                b = a + 2 * m;
+                c = b + 2 * m;
+                d = c + 2 * m;
+
+                /* First step, twiddle W_2m^j */
+                br = b[0]; bi = b[1];
+                FFT_TWIDDLE(br, bi, 2 * j * step);
+                dr = d[0]; di = d[1];
+                FFT_TWIDDLE(dr, di, 2 * j * step);
+                ar = (a[0] + br) >> 1; ai = (a[1] + bi) >> 1;
+                br = (a[0] - br) >> 1; bi = (a[1] - bi) >> 1;
+                cr = (c[0] + dr) >> 1; ci = (c[1] + di) >> 1;
+                dr = (c[0] - dr) >> 1; di = (c[1] - di) >> 1;
+
+                /* Second step, twiddle W_4m^j, and -i W_4m^j for b and d */
+                FFT_TWIDDLE(cr, ci, j * step);
+                FFT_TWIDDLE(dr, di, j * step);
+                tr = di;
+                ti = -dr;
+                a[0] = (ar + cr) >> 1; a[1] = (ai + ci) >> 1;
+                c[0] = (ar - cr) >> 1; c[1] = (ai - ci) >> 1;
+                b[0] = (br + tr) >> 1; b[1] = (bi + ti) >> 1;
+                d[0] = (br - tr) >> 1; d[1] = (bi - ti) >> 1;
+            }
+        }
+    }
+}
+
+/*
+ * Magnitude of the first n / 2 bins, e.g. to draw on the LCD. Uses
+ * max + 3/8 min in place of a square root, which is within 7%.
+ */
+void FFT_magnitude(const int16_t *data, uint16_t *magnitude, int n) {
+
+    uint32_t re, im;
+    int i;
+
+    for(i = 0; i < n / 2; i++) {
+        re = abs(data[2 * i]);
+        im = abs(data[2 * i + 1]);
+        magnitude[i] = (re > im) ? re + ((3 * im) >> 3) : im + ((3 * re) >> 3);
+    }
+}
+
+/*
+ * Set up a detector for one tone.
+ *
+ * param toneHz, sampleHz
+ *          The frequency to detect and the ADC sample rate. The tone is
+ *          rounded to a multiple of sampleHz / 1024.
+ *
+ * param length
+ *          Samples per result, up to 1024. Longer gives a narrower band,
+ *          sampleHz / length wide, but a slower answer.
+ */
+void GOERTZEL_init(goertzel *g, uint32_t toneHz, uint32_t sampleHz, int length) {
+
+    uint32_t k = (uint32_t)(((uint64_t)toneHz * FFT_MAX_SIZE + sampleHz / 2) / sampleHz);
+
+    if(length < 1 || length > 1024 || k >= FFT_MAX_SIZE / 2)
+        exit(EXIT_FAILURE);
+
+    g->coeff = fftSine[k + 256]; //cos in Q15 is 2cos in Q14
+    g->length = length;
+    g->count = 0;
+    g->s1 = 0;
+    g->s2 = 0;
+}
+
+/*
+ * Run a block of raw ADC results through the detector.
+ *
+ * param power
+ *          Set at the end of every length samples to the squared amplitude
+ *          of the tone, in ADC counts squared.
+ *
+ * returns the number of results stored, normally 0 or 1.
+ */
+int GOERTZEL_block(goertzel *g, const uint16_t *in, int n, uint32_t *power) {
+
+    int32_t s0, s1 = g->s1, s2 = g->s2;
+    int64_t p;
+    int produced = 0;
+    int i;
+
+    for(i = 0; i < n; i++) {
+        s0 = ((int32_t)in[i] - 2048) + (int32_t)(((int64_t)g->coeff * s1) >> 14) - s2;
+        s2 = s1;
+        s1 = s0;
+
+        if(++g->count == g->length) {
+            /* |X|^2, then A^2 = 4 |X|^2 / length^2 for a sine of amplitude A */
+            p = (int64_t)s1 * s1 + (int64_t)s2 * s2 - (((int64_t)g->coeff * s1) >> 14) * s2;
+            power[produced++] = (uint32_t)((4 * p) / ((int64_t)g->length * g->length));
+            g->count = 0;
+            s1 = 0;
+            s2 = 0;
+        }
+    }
+
+    g->s1 = s1;
+    g->s2 = s2;
+
+    return produced;
+}
@@ -0,0 +1,38 @@
+/*
+ * fft.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: bjh885
+ *
+ * Fixed point spectrum analysis for ADC blocks. FFT_q15() is an in place
+ * radix-4 FFT, with one radix-2 pass first when the size is not a power of
+ * four. Its twiddle factors come from one const sine table, so they stay in
+ * flash. For one or a few known frequencies, a goertzel detector per tone
+ * is far cheaper than a whole FFT.
+ */
+
+#ifndef FFT_H_
+#define FFT_H_
+
+#include <inttypes.h>
+
+#define FFT_MIN_SIZE 64
+#define FFT_MAX_SIZE 1024
+
+/* Single tone detector, see GOERTZEL_init() */
+typedef struct {
+    int32_t coeff;          /* 2cos(w) in Q14 */
+    int length;             /* samples per result */
+    int count;
+    int32_t s1;
+    int32_t s2;
+} goertzel;
+
+void FFT_fromAdc(const uint16_t *, int16_t *, int);
+void FFT_q15(int16_t *, int);
+void FFT_magnitude(const int16_t *, uint16_t *, int);
+
+void GOERTZEL_init(goertzel *, uint32_t, uint32_t, int);
+int GOERTZEL_block(goertzel *, const uint16_t *, int, uint32_t *);
+
+#endif /* FFT_H_ */
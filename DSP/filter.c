@@ -0,0 +1,241 @@
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dsp.h"
+#include "filter.h"
+
+/*
+ * Convert raw 12 bit ADC results to Q15 centred on mid scale, so 0 becomes
+ * -1.0 and 4095 just under 1.0. Two results are handled per 32-bit word:
+ * moving the 12 bits to the top of each half and flipping the sign bit is
+ * the same as subtracting 2048, without a borrow crossing between halves.
+ */
+void FILTER_fromAdc(const uint16_t *in, int16_t *out, int n) {
+
+    uint32_t word;
+    int i = 0;
+
+    for(; i + 2 <= n; i += 2) {
+        memcpy(&word, in + i, 4);
+        word = ((word << 4) & 0xFFF0FFF0) ^ 0x80008000;
+        memcpy(out + i, &word, 4);
+    }
+    if(i < n)
+        out[i] = (int16_t)((((uint32_t)in[i] << 4) & 0xFFF0) ^ 0x8000);
+}
+
+/*
+ * param coeffs
+ *          taps Q15 coefficients. Kept by reference, not copied.
+ *
+ * param state
+ *          Room for 2 * taps values.
+ */
+void FILTER_initFirQ15(firQ15 *fir, const int16_t *coeffs, int16_t *state, int taps) {
+
+    if(taps < 1)
+        exit(EXIT_FAILURE);
+
+    fir->coeffs = coeffs;
+    fir->state = state;
+    fir->taps = taps;
+    fir->index = 0;
+    memset(state, 0, 2 * taps * sizeof(int16_t));
+}
+
+/*
+ * Filter n samples. in and out may be the same buffer. The sum of products
+ * is kept in 64 bits, two taps per SMLALD, so long filters cannot overflow
+ * before the result is saturated back to Q15.
+ */
+void FILTER_firQ15(firQ15 *fir, const int16_t *in, int16_t *out, int n) {
+
+    const int16_t *h = fir->coeffs;
+    int taps = fir->taps;
+    const int16_t *x;
+    int64_t acc;
+    int i, k;
+
+    for(i = 0; i < n; i++) {
+        /* Newest sample goes in front, and its mirror a length further on */
+        fir->index = (fir->index == 0) ? taps - 1 : fir->index - 1;
+        fir->state[fir->index] = in[i];
+        fir->state[fir->index + taps] = in[i];
+        x = fir->state + fir->index; //x[k] is the input k samples ago
+
+        acc = 0;
+        for(k = 0; k + 2 <= taps; k += 2)
+            acc = DSP_SMLALD(DSP_pair(h + k), DSP_pair(x + k), acc);
+        if(k < taps)
+            acc += (int32_t)h[k] * x[k];
+
+        out[i] = DSP_saturate16(acc >> 15);
+    }
+}
+
+void FILTER_initFirQ31(firQ31 *fir, const int32_t *coeffs, int32_t *state, int taps) {
+
+    if(taps < 1)
+        exit(EXIT_FAILURE);
+
+    fir->coeffs = coeffs;
+    fir->state = state;
+    fir->taps = taps;
+    fir->index = 0;
+    memset(state, 0, 2 * taps * sizeof(int32_t));
+}
+
+/*
+ * As FILTER_firQ15() for Q31 data. Each product is an SMLAL into the 64-bit
+ * sum, which holds 2^32 / taps full scale products before it can overflow.
+ */
+void FILTER_firQ31(firQ31 *fir, const int32_t *in, int32_t *out, int n) {
+
+    const int32_t *h = fir->coeffs;
+    int taps = fir->taps;
+    const int32_t *x;
+    int64_t acc;
+    int i, k;
+
+    for(i = 0; i < n; i++) {
+        fir->index = (fir->index == 0) ? taps - 1 : fir->index - 1;
+        fir->state[fir->index] = in[i];
+        fir->state[fir->index + taps] = in[i];
+        x = fir->state + fir->index;
+
+        acc = 0;
+        for(k = 0; k < taps; k++)
+            acc += (int64_t)h[k] * x[k];
+
+        out[i] = DSP_saturate32(acc >> 31);
+    }
+}
+
+/*
+ * param coeffs
+ *          5 * stages coefficients, see biquadQ15.
+ *
+ * param state
+ *          Room for 4 * stages values.
+ *
+ * param postShift
+ *          0 - 3. The coefficients are in Q(15 - postShift).
+ */
+void FILTER_initBiquadQ15(biquadQ15 *bq, const int16_t *coeffs, int16_t *state, int stages, int postShift) {
+
+    if(stages < 1 || postShift < 0 || postShift > 3)
+        exit(EXIT_FAILURE);
+
+    bq->coeffs = coeffs;
+    bq->state = state;
+    bq->stages = stages;
+    bq->postShift = postShift;
+    memset(state, 0, 4 * stages * sizeof(int16_t));
+}
+
+/*
+ * Run n samples through every stage in turn. The state of a stage is
+ * {x[n-1], x[n-2], y[n-1], y[n-2]}, which lines up with {b1, b2} and
+ * {a1, a2} so each pair is one SMLALD.
+ */
+void FILTER_biquadQ15(biquadQ15 *bq, const int16_t *in, int16_t *out, int n) {
+
+    const int16_t *c = bq->coeffs;
+    int16_t *s = bq->state;
+    int shift = 15 - bq->postShift;
+    int16_t x, y;
+    int64_t acc;
+    int stage, i;
+
+    for(stage = 0; stage < bq->stages; stage++, c += 5, s += 4) {
+        for(i = 0; i < n; i++) {
+            x = in[i];
+            acc = (int32_t)c[0] * x;
+            acc = DSP_SMLALD(DSP_pair(c + 1), DSP_pair(s), acc);
+            acc = DSP_SMLALD(DSP_pair(c + 3), DSP_pair(s + 2), acc);
+            y = DSP_saturate16(acc >> shift);
+
+            s[1] = s[0];
+            s[0] = x;
+            s[3] = s[2];
+            s[2] = y;
+            out[i] = y;
+        }
+        in = out; //later stages work in place on the output
+    }
+}
+
+/*
+ * As FILTER_initBiquadQ15() for Q31 data. The coefficients are in
+ * Q(31 - postShift).
+ */
+void FILTER_initBiquadQ31(biquadQ31 *bq, const int32_t *coeffs, int32_t *state, int stages, int postShift) {
+
+    if(stages < 1 || postShift < 0 || postShift > 3)
+        exit(EXIT_FAILURE);
+
+    bq->coeffs = coeffs;
+    bq->state = state;
+    bq->stages = stages;
+    bq->postShift = postShift;
+    memset(state, 0, 4 * stages * sizeof(int32_t));
+}
+
+void FILTER_biquadQ31(biquadQ31 *bq, const int32_t *in, int32_t *out, int n) {
+
+    const int32_t *c = bq->coeffs;
+    int32_t *s = bq->state;
+    int shift = 31 - bq->postShift;
+    int32_t x, y;
+    int64_t acc;
+    int stage, i;
+
+    for(stage = 0; stage < bq->stages; stage++, c += 5, s += 4) {
+        for(i = 0; i < n; i++) {
+            x = in[i];
+            acc = (int64_t)c[0] * x + (int64_t)c[1] * s[0] + (int64_t)c[2] * s[1] +
+                  (int64_t)c[3] * s[2] + (int64_t)c[4] * s[3];
+            y = DSP_saturate32(acc >> shift);
+
+            s[1] = s[0];
+            s[0] = x;
+            s[3] = s[2];
+            s[2] = y;
+            out[i] = y;
+        }
+        in = out;
+    }
+}
+
+/*
+ * param history
+ *          Room for length values.
+ */
+void FILTER_initMovingAverage(movingAverage *ma, int16_t *history, int length) {
+
+    if(length < 1)
+        exit(EXIT_FAILURE);
+
+    ma->history = history;
+    ma->length = length;
+    ma->index = 0;
+    ma->sum = 0;
+    memset(history, 0, length * sizeof(int16_t));
+}
+
+/*
+ * Each output costs one add and one subtract whatever the length, since the
+ * sum is carried along rather than recomputed.
+ */
+void FILTER_movingAverage(movingAverage *ma, const int16_t *in, int16_t *out, int n) {
+
+    int i;
+
+    for(i = 0; i < n; i++) {
+        ma->sum += in[i] - ma->history[ma->index];
+        ma->history[ma->index] = in[i];
+        if(++ma->index == ma->length)
+            ma->index = 0;
+        out[i] = (int16_t)(ma->sum / ma->length);
+    }
+}
@@ -0,0 +1,83 @@
+/*
+ * filter.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: bjh885
+ *
+ * Block based fixed point filters for ADC data. Every filter keeps its
+ * history between calls, so a stream can be fed one acquisition block at a
+ * time. FILTER_fromAdc() turns raw 12 bit results into the Q15 the filters
+ * take. The caller provides all storage.
+ */
+
+#ifndef FILTER_H_
+#define FILTER_H_
+
+#include <inttypes.h>
+
+/*
+ * FIR filter. state holds 2 * taps values, so the last taps inputs can
+ * always be read as one straight run instead of wrapping.
+ */
+typedef struct {
+    const int16_t *coeffs;  /* h[0] .. h[taps-1] in Q15 */
+    int16_t *state;
+    int taps;
+    int index;
+} firQ15;
+
+typedef struct {
+    const int32_t *coeffs;  /* h[0] .. h[taps-1] in Q31 */
+    int32_t *state;
+    int taps;
+    int index;
+} firQ31;
+
+/*
+ * Cascade of second order sections in direct form I. Each stage has five
+ * coefficients {b0, b1, b2, a1, a2} and computes
+ *
+ *      y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] + a1 y[n-1] + a2 y[n-2]
+ *
+ * so a1 and a2 are the negated denominator terms. Coefficients are scaled
+ * down by 2^postShift to fit, e.g. postShift 1 allows |coefficient| < 2.
+ * state holds 4 values per stage.
+ */
+typedef struct {
+    const int16_t *coeffs;
+    int16_t *state;
+    int stages;
+    int postShift;
+} biquadQ15;
+
+typedef struct {
+    const int32_t *coeffs;
+    int32_t *state;
+    int stages;
+    int postShift;
+} biquadQ31;
+
+/* Running mean of the last length inputs. history holds length values */
+typedef struct {
+    int16_t *history;
+    int length;
+    int index;
+    int32_t sum;
+} movingAverage;
+
+void FILTER_fromAdc(const uint16_t *, int16_t *, int);
+
+void FILTER_initFirQ15(firQ15 *, const int16_t *, int16_t *, int);
+void FILTER_firQ15(firQ15 *, const int16_t *, int16_t *, int);
+void FILTER_initFirQ31(firQ31 *, const int32_t *, int32_t *, int);
+void FILTER_firQ31(firQ31 *, const int32_t *, int32_t *, int);
+
+void FILTER_initBiquadQ15(biquadQ15 *, const int16_t *, int16_t *, int, int);
+void FILTER_biquadQ15(biquadQ15 *, const int16_t *, int16_t *, int);
+void FILTER_initBiquadQ31(biquadQ31 *, const int32_t *, int32_t *, int, int);
+void FILTER_biquadQ31(biquadQ31 *, const int32_t *, int32_t *, int);
+
+void FILTER_initMovingAverage(movingAverage *, int16_t *, int);
+void FILTER_movingAverage(movingAverage *, const int16_t *, int16_t *, int);
+
+#endif /* FILTER_H_ */
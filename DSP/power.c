@@ -0,0 +1,100 @@
+#include <inttypes.h>
+#include <stdlib.h>
+#include "dsp.h"
+#include "power.h"
+
+/*
+ * Angle of (x, y) in centidegrees, -18000 to 18000. Uses
+ * atan(z) = 45z + 15.64z(1 - z) degrees on the first octant, which is
+ * within 0.25 degrees.
+ */
+int32_t POWER_atan2(int32_t y, int32_t x) {
+
+    uint32_t ax = (uint32_t)abs(x);
+    uint32_t ay = (uint32_t)abs(y);
+    int64_t z;              /* min / max in Q15 */
+    int32_t angle;
+
+    if(ax == 0 && ay == 0)
+        return 0;
+
+    z = ((int64_t)((ax < ay) ? ax : ay) << 15) / ((ax < ay) ? ay : ax);
+    angle = (int32_t)((4500 * z + ((1564 * z * (32768 - z)) >> 15)) >> 15);
+
+    if(ay > ax)
+        angle = 9000 - angle;
+    if(x < 0)
+        angle = 18000 - angle;
+    if(y < 0)
+        angle = -angle;
+
+    return angle;
+}
+
+/*
+ * Measure a block of voltage/current pairs.
+ *
+ * param pairs
+ *          n pairs from ADC_syncAcquire() or ADC_syncSample().
+ *
+ * The phase sign comes from the cross term v[k] i[k-1] - v[k-1] i[k], which
+ * is negative when the current lags. Its size comes from the active and
+ * apparent power, so it does not depend on the mains frequency.
+ */
+void POWER_measure(const adcPair *pairs, int n, powerResult *result) {
+
+    int64_t sum0 = 0, sum1 = 0;
+    int64_t square0 = 0, square1 = 0, product = 0, cross = 0;
+    int32_t mean0, mean1;
+    int32_t v, i, lastV = 0, lastI = 0;
+    uint64_t apparent16;
+    uint32_t reactive;
+    int64_t pf;
+    int k;
+
+    if(n < 2)
+        exit(EXIT_FAILURE);
+
+    for(k = 0; k < n; k++) {
+        sum0 += pairs[k].adc0;
+        sum1 += pairs[k].adc1;
+    }
+    mean0 = (int32_t)(sum0 / n);
+    mean1 = (int32_t)(sum1 / n);
+
+    for(k = 0; k < n; k++) {
+        v = pairs[k].adc0 - mean0;
+        i = pairs[k].adc1 - mean1;
+        square0 += v * v;
+        square1 += i * i;
+        product += v * i;
+        if(k > 0)
+            cross += v * lastI - lastV * i;
+        lastV = v;
+        lastI = i;
+    }
+
+    /* 256 times the mean square gives the root in 1/16 count */
+    result->rms0 = DSP_sqrt((uint64_t)square0 * 256 / n);
+    result->rms1 = DSP_sqrt((uint64_t)square1 * 256 / n);
+    result->active = (int32_t)(product / n);
+
+    apparent16 = (uint64_t)result->rms0 * result->rms1; //counts squared * 256
+    result->apparent = (uint32_t)(apparent16 >> 8);
+
+    if(apparent16 == 0) {
+        result->powerFactor = 0;
+        result->phase = 0;
+        return;
+    }
+
+    pf = ((int64_t)result->active << 23) / (int64_t)apparent16; //Q15
+    if(pf > 32767)
+        pf = 32767;
+    if(pf < -32767)
+        pf = -32767;
+    result->powerFactor = (int16_t)pf;
+
+    reactive = DSP_sqrt((uint64_t)32767 * 32767 - pf * pf); //sin of the phase, Q15
+    result->phase = POWER_atan2((cross < 0) ? (int32_t)reactive : -(int32_t)reactive, (int32_t)pf);
+}
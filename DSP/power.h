@@ -0,0 +1,32 @@
+/*
+ * power.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: bjh885
+ *
+ * Power measurements on the paired blocks from ADC_syncAcquire(), with
+ * voltage on ADC0 and current on ADC1. Everything is in ADC counts, so
+ * scale by the volts and amps per count of the front end afterwards. The
+ * DC offset of each channel is taken out per block, and a block should hold
+ * a whole number of mains cycles for the results to be steady.
+ */
+
+#ifndef POWER_H_
+#define POWER_H_
+
+#include <inttypes.h>
+#include "ADC/adc.h"
+
+typedef struct {
+    uint32_t rms0;          /* RMS of each channel, in 1/16 count */
+    uint32_t rms1;
+    int32_t active;         /* mean of v * i, counts squared */
+    uint32_t apparent;      /* rms0 * rms1, counts squared */
+    int16_t powerFactor;    /* active / apparent in Q15 */
+    int32_t phase;          /* centidegrees, positive when ADC1 lags ADC0 */
+} powerResult;
+
+void POWER_measure(const adcPair *, int, powerResult *);
+int32_t POWER_atan2(int32_t, int32_t);
+
+#endif /* POWER_H_ */
@@ -0,0 +1,241 @@
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dsp.h"
+#include "stats.h"
+
+/*
+ * Set up an accumulator.
+ *
+ * param mode
+ *          STATS_CUMULATIVE, STATS_WINDOW or STATS_DECAY
+ *
+ * param window
+ *          STATS_WINDOW: room for length samples. Otherwise 0.
+ *
+ * param length
+ *          STATS_WINDOW: samples in the window, 1 - 65535.
+ *          STATS_DECAY: the shift, 1 - 16, for a time constant of
+ *          2^length samples.
+ *          STATS_CUMULATIVE: unused.
+ */
+void STATS_init(statsAccumulator *acc, int mode, uint16_t *window, int length) {
+
+    if(mode == STATS_WINDOW && (!window || length < 1 || length > 65535))
+        exit(EXIT_FAILURE);
+    if(mode == STATS_DECAY && (length < 1 || length > 16))
+        exit(EXIT_FAILURE);
+    if(mode != STATS_CUMULATIVE && mode != STATS_WINDOW && mode != STATS_DECAY)
+        exit(EXIT_FAILURE);
+
+    acc->mode = mode;
+    acc->window = window;
+    acc->length = (mode == STATS_WINDOW) ? length : 0;
+    acc->shift = (mode == STATS_DECAY) ? length : 0;
+    acc->sequence = 0;
+    STATS_reset(acc);
+}
+
+/* Make the working totals visible to STATS_snapshot() */
+static void STATS_publish(statsAccumulator *acc) {
+
+    acc->sequence++; //odd while the copy is in progress
+    acc->published = acc->work;
+    acc->sequence++;
+}
+
+/*
+ * Forget everything seen so far
+ */
+void STATS_reset(statsAccumulator *acc) {
+
+    memset(&acc->work, 0, sizeof(acc->work));
+    acc->work.min = 0xFFFF;
+    acc->index = 0;
+    acc->lastMin = acc->passMin = 0xFFFF;
+    acc->lastMax = acc->passMax = 0;
+    STATS_publish(acc);
+}
+
+/*
+ * Fold up to STATS_CHUNK samples into the cumulative totals. The chunk is
+ * summed exactly in integers, then merged with the totals so far (Chan et
+ * al.): the mean moves by delta * nb / n and m2 gains the chunk's own m2
+ * plus delta^2 * na * nb / n. That is a few divisions per chunk instead of
+ * one per sample.
+ */
+static void STATS_chunk(statsAccumulator *acc, const uint16_t *samples, int nb) {
+
+    statsState *s = &acc->work;
+    uint32_t sum = 0;
+    uint64_t squares = 0;
+    uint64_t n = (uint64_t)s->count + nb;
+    int64_t delta, step;
+    uint64_t t;
+    uint16_t x;
+    int i;
+
+    for(i = 0; i < nb; i++) {
+        x = samples[i];
+        sum += x;
+        squares += (uint32_t)x * x;
+        if(x < s->min)
+            s->min = x;
+        if(x > s->max)
+            s->max = x;
+    }
+
+    delta = (int64_t)((((uint64_t)sum << 16) + nb / 2) / nb) - s->mean; //Q16
+    t = (uint64_t)(delta * delta) >> 28; //delta^2 in Q4
+
+    /* Rounded, or a mean that keeps moving one way drifts behind */
+    step = delta * nb;
+    s->mean += (step + ((step < 0) ? -(int64_t)(n / 2) : (int64_t)(n / 2))) / (int64_t)n;
+    s->m2 += ((squares * nb - (uint64_t)sum * sum) << 4) / nb; //this chunk, Q4
+    s->m2 += t * nb - t * nb * nb / n; //na * nb / n = nb - nb^2 / n
+    s->squares += squares;
+    s->count = (uint32_t)n;
+}
+
+static void STATS_update(statsAccumulator *acc, uint16_t x) {
+
+    statsState *s = &acc->work;
+    int64_t value = (int64_t)x << 16;
+    int64_t delta;
+    uint64_t deltaSquared;
+    uint16_t old;
+
+    switch(acc->mode) {
+
+        case STATS_WINDOW:
+            old = acc->window[acc->index];
+            if(s->count < (uint32_t)acc->length)
+                s->count++;
+            else {
+                s->sum -= old;
+                s->squares -= (uint32_t)old * old;
+            }
+            acc->window[acc->index] = x;
+            s->sum += x;
+            s->squares += (uint32_t)x * x;
+
+            /* Extremes of this pass and the one before, so always at least
+             * the whole window and at most two of them */
+            if(x < acc->passMin)
+                acc->passMin = x;
+            if(x > acc->passMax)
+                acc->passMax = x;
+            if(++acc->index == acc->length) {
+                acc->index = 0;
+                acc->lastMin = acc->passMin;
+                acc->lastMax = acc->passMax;
+                acc->passMin = 0xFFFF;
+                acc->passMax = 0;
+            }
+            s->min = (acc->passMin < acc->lastMin) ? acc->passMin : acc->lastMin;
+            s->max = (acc->passMax > acc->lastMax) ? acc->passMax : acc->lastMax;
+            return;
+
+        case STATS_DECAY:
+            /* var = (1 - a)(var + a delta^2), with a = 2^-shift */
+            if(s->count++ == 0) {
+                s->mean = value;
+                s->squares = (uint64_t)x * x << 8;
+                break;
+            }
+            delta = value - s->mean;
+            s->mean += delta >> acc->shift;
+            deltaSquared = (uint64_t)((delta >> 8) * (delta >> 8)); //Q16
+            s->m2 += (deltaSquared >> acc->shift) - (s->m2 >> acc->shift) -
+                     (deltaSquared >> (2 * acc->shift));
+            s->squares += (int64_t)(((uint64_t)x * x << 8) - s->squares) >> acc->shift;
+            break;
+    }
+
+    if(x < s->min)
+        s->min = x;
+    if(x > s->max)
+        s->max = x;
+}
+
+/*
+ * Add one sample. The totals are published on every call, and cumulative
+ * mode divides on every call, so prefer STATS_block() in an interrupt.
+ */
+void STATS_add(statsAccumulator *acc, uint16_t x) {
+
+    STATS_block(acc, &x, 1);
+}
+
+/*
+ * Add a block of samples, e.g. from an acquisition blockDone callback. The
+ * totals are published once, at the end.
+ */
+void STATS_block(statsAccumulator *acc, const uint16_t *samples, int n) {
+
+    int i;
+
+    if(acc->mode == STATS_CUMULATIVE) {
+        for(i = 0; i < n; i += STATS_CHUNK)
+            STATS_chunk(acc, samples + i, (n - i < STATS_CHUNK) ? n - i : STATS_CHUNK);
+    }
+    else {
+        for(i = 0; i < n; i++)
+            STATS_update(acc, samples[i]);
+    }
+    STATS_publish(acc);
+}
+
+/*
+ * Read the statistics. Safe to call from the main loop while an interrupt
+ * is still adding samples, and never disables interrupts.
+ */
+void STATS_snapshot(statsAccumulator *acc, statsSnapshot *out) {
+
+    statsState s;
+    uint32_t sequence;
+    uint64_t meanSquare;
+    int64_t sumSquared;
+
+    do {
+        sequence = acc->sequence;
+        s = acc->published;
+    } while((sequence & 1) || sequence != acc->sequence);
+
+    out->count = s.count;
+    out->min = s.count ? s.min : 0;
+    out->max = s.max;
+    if(s.count == 0) {
+        out->mean = 0;
+        out->variance = 0;
+        out->stdDev = 0;
+        out->rms = 0;
+        return;
+    }
+
+    switch(acc->mode) {
+
+        case STATS_CUMULATIVE:
+            out->mean = (int32_t)(s.mean >> 12);
+            out->variance = (uint32_t)(s.m2 / s.count);
+            meanSquare = s.squares * 256 / s.count;
+            break;
+
+        case STATS_WINDOW:
+            out->mean = (int32_t)(((uint64_t)s.sum << 4) / s.count);
+            sumSquared = (int64_t)s.sum * s.sum;
+            out->variance = (uint32_t)((((int64_t)s.squares * s.count - sumSquared) << 4) /
+                                       ((int64_t)s.count * s.count));
+            meanSquare = s.squares * 256 / s.count;
+            break;
+
+        default:
+            out->mean = (int32_t)(s.mean >> 12);
+            out->variance = (uint32_t)(s.m2 >> 12);
+            meanSquare = s.squares;
+            break;
+    }
+
+    out->stdDev = DSP_sqrt((uint64_t)out->variance << 4);
+    out->rms = DSP_sqrt(meanSquare);
+}
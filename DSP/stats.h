@@ -0,0 +1,73 @@
+/*
+ * stats.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: bjh885
+ *
+ * Running statistics of an ADC sample stream at a fixed cost per sample, so
+ * no raw samples need to be kept. Feed it from an acquisition blockDone
+ * callback with STATS_block(). Results are read with STATS_snapshot(),
+ * which never blocks the interrupt doing the feeding: the totals are
+ * published under a sequence counter and the reader retries if a new block
+ * arrived while it was copying.
+ */
+
+#ifndef STATS_H_
+#define STATS_H_
+
+#include <inttypes.h>
+
+/* Samples cumulative mode sums exactly before merging, so the sums fit */
+#define STATS_CHUNK 4096
+
+/*
+ * Modes for STATS_init(). Cumulative mode counts in 32 bits, so reset it
+ * before 2^32 samples, about 71 minutes at 1Msps. Within that m2 cannot
+ * overflow: even full scale deviations reach less than 2^59.
+ */
+#define STATS_CUMULATIVE    0   /* everything since STATS_reset() */
+#define STATS_WINDOW        1   /* the last length samples */
+#define STATS_DECAY         2   /* exponentially weighted, time constant 2^shift samples */
+
+/* Totals published to readers. Their meaning depends on the mode */
+typedef struct {
+    uint32_t count;         /* samples seen, or held in the window */
+    uint16_t min;
+    uint16_t max;
+    int64_t mean;           /* Q16. Cumulative and decay */
+    uint64_t m2;            /* sum of squared deviations in Q4, or variance in Q16 in decay */
+    uint64_t squares;       /* sum of x^2, or mean of x^2 in Q8 in decay */
+    uint32_t sum;           /* window only */
+} statsState;
+
+typedef struct {
+    int mode;
+    int shift;                  /* decay */
+    uint16_t *window;           /* window, length samples */
+    int length;
+    int index;
+    uint16_t lastMin, lastMax;  /* window, extremes of the previous pass */
+    uint16_t passMin, passMax;  /* window, extremes of this pass */
+    statsState work;
+    volatile uint32_t sequence;
+    volatile statsState published;
+} statsAccumulator;
+
+/* Results, in 1/16 count so small signals keep some resolution */
+typedef struct {
+    uint32_t count;
+    uint16_t min;
+    uint16_t max;
+    int32_t mean;
+    uint32_t variance;      /* counts squared * 16 */
+    uint32_t stdDev;
+    uint32_t rms;
+} statsSnapshot;
+
+void STATS_init(statsAccumulator *, int, uint16_t *, int);
+void STATS_reset(statsAccumulator *);
+void STATS_add(statsAccumulator *, uint16_t);
+void STATS_block(statsAccumulator *, const uint16_t *, int);
+void STATS_snapshot(statsAccumulator *, statsSnapshot *);
+
+#endif /* STATS_H_ */
@@ -0,0 +1,98 @@
+#include "tm4c123gh6pm.h"
+#include <inttypes.h>
+#include <stdlib.h>
+#include "EEPROM/eeprom.h"
+
+/* Wait for the EEPROM to finish a write or its start up, p.551 */
+static void EEPROM_wait(void) {
+
+    while(EEPROM_EEDONE_R & 0x01); //WORKING
+}
+
+/*
+ * Turn on the EEPROM, following the start up steps on p.537. A write that
+ * was cut short by a reset is finished off first.
+ *
+ * returns 0, or -1 if the EEPROM reports a failed erase or copy.
+ */
+int init_eeprom(void) {
+
+    volatile unsigned long delay_clk;
+
+    SYSCTL_RCGCEEPROM_R |= 0x01; //p.356
+    delay_clk = SYSCTL_RCGCEEPROM_R; //dummy operation for clock to settle
+    delay_clk = SYSCTL_RCGCEEPROM_R;
+    EEPROM_wait();
+
+    if(EEPROM_EESUPP_R & 0x0C) //PRETRY, ERETRY
+        return -1;
+
+    /* Reset the module so the recovery above takes effect */
+    SYSCTL_SREEPROM_R |= 0x01;
+    delay_clk = SYSCTL_SREEPROM_R;
+    SYSCTL_SREEPROM_R &= ~0x01;
+    delay_clk = SYSCTL_SREEPROM_R;
+    EEPROM_wait();
+
+    if(EEPROM_EESUPP_R & 0x0C)
+        return -1;
+
+    return 0;
+}
+
+/*
+ * Point the EEPROM at a word
+ */
+static void EEPROM_seek(int word) {
+
+    EEPROM_EEBLOCK_R = word / 16; //p.540
+    EEPROM_EEOFFSET_R = word % 16; //p.541
+}
+
+/*
+ * param word
+ *          First word to read, 0 - 511.
+ *
+ * param count
+ *          Number of words, up to the end of the EEPROM.
+ *
+ * returns 0.
+ */
+int EEPROM_read(int word, uint32_t *data, int count) {
+
+    int i;
+
+    if(word < 0 || count < 0 || word + count > EEPROM_WORDS)
+        exit(EXIT_FAILURE);
+
+    for(i = 0; i < count; i++) {
+        EEPROM_seek(word + i);
+        data[i] = EEPROM_EERDWR_R;
+    }
+
+    return 0;
+}
+
+/*
+ * Write words, waiting for each to be programmed. Takes around 30us a word
+ * at worst, longer when the EEPROM needs to copy a full sector.
+ *
+ * returns 0, or -1 if a block is protected.
+ */
+int EEPROM_write(int word, const uint32_t *data, int count) {
+
+    int i;
+
+    if(word < 0 || count < 0 || word + count > EEPROM_WORDS)
+        exit(EXIT_FAILURE);
+
+    for(i = 0; i < count; i++) {
+        EEPROM_seek(word + i);
+        EEPROM_EERDWR_R = data[i];
+        EEPROM_wait();
+        if(EEPROM_EEDONE_R & 0x10) //NOPERM
+            return -1;
+    }
+
+    return 0;
+}
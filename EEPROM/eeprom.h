@@ -0,0 +1,21 @@
+#include <inttypes.h>
+/*
+ * eeprom.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: bjh885
+ *
+ * The 2KB on-chip EEPROM, addressed in 32-bit words. It is made of 32
+ * blocks of 16 words, p.535.
+ */
+
+#ifndef EEPROM_H_
+#define EEPROM_H_
+
+#define EEPROM_WORDS 512
+
+int init_eeprom(void);
+int EEPROM_read(int, uint32_t *, int);
+int EEPROM_write(int, const uint32_t *, int);
+
+#endif /* EEPROM_H_ */
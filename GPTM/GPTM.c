@@ -203,3 +203,85 @@ void init_timer0B_periodic(int config, int dir, int snap, int wot, int load) {
     /* Enable the timer */
     TIMER0_CTL_R |= 0x0100;
 }
+/*
+ * Run Timer 1A as a 32-bit periodic timer whose timeout triggers the ADC.
+ * Use with an ADC sample sequencer set to the timer trigger (0x05). The
+ * sample rate is exact and free of software jitter, since no code runs
+ * between samples.
+ *
+ * param period:
+ *          Bus clock cycles between triggers. The sample rate is
+ *          busFrequency / period, e.g. 800 for 100ksps on an 80MHz bus.
+ */
+void init_timer1A_ADCtrigger(uint32_t period) {
+
+    volatile unsigned long delay_clk;
+    SYSCTL_RCGCTIMER_R |= 0x02;
+    delay_clk = SYSCTL_RCGCTIMER_R; //delay to allow the clock to settle, no operation
+    /* Disable TimerA for setup */
+    TIMER1_CTL_R &= ~0x0001; //Pg. 690
+    TIMER1_CFG_R = 0x000; //Pg. 680, 32 bit timer
+    TIMER1_TAMR_R = 0x02; //Periodic, counting down
+    TIMER1_TAILR_R = period - 1;
+    TIMER1_IMR_R &= ~0x01; //No timeout interrupt, only the ADC trigger
+    TIMER1_CTL_R |= 0x0020; //Pg. 690, TAOTE - timeout triggers the ADC
+    /* Enable the timer */
+    TIMER1_CTL_R |= 0x0001;
+}
+
+/*
+ * Stop the ADC trigger timer started by init_timer1A_ADCtrigger()
+ */
+void stop_timer1A(void) {
+
+    TIMER1_CTL_R &= ~0x0001;
+}
+
+/* Called from Timer2A_Handler() on every timeout */
+static void (*timer2ATick)(void) = 0;
+
+/*
+ * Run Timer 2A as a 32-bit periodic timer that calls tick from its
+ * interrupt, for slow background jobs such as logging the temperature.
+ *
+ * param period:
+ *          Bus clock cycles between calls, e.g. 80000000 for once a second
+ *          on an 80MHz bus.
+ *
+ * param pri:
+ *          The priority of the interrupt, 0 to 7.
+ */
+void init_timer2A_periodicInterrupt(uint32_t period, int pri, void (*tick)(void)) {
+
+    volatile unsigned long delay_clk;
+    SYSCTL_RCGCTIMER_R |= 0x04;
+    delay_clk = SYSCTL_RCGCTIMER_R; //delay to allow the clock to settle, no operation
+    timer2ATick = tick;
+    /* Disable TimerA for setup */
+    TIMER2_CTL_R &= ~0x0001; //Pg. 690
+    TIMER2_CFG_R = 0x000; //Pg. 680, 32 bit timer
+    TIMER2_TAMR_R = 0x02; //Periodic, counting down
+    TIMER2_TAILR_R = period - 1;
+    TIMER2_ICR_R = 0x01; //clear any old timeout
+    TIMER2_IMR_R |= 0x01; //timeout interrupt
+    NVIC_PRI5_R = (NVIC_PRI5_R & ~0xE0000000) | ((unsigned long)pri << 29); /* 4n+3. bits 31:29. n = 5 */
+    NVIC_EN0_R = 0x00800000; /* bit 23 */
+    /* Enable the timer */
+    TIMER2_CTL_R |= 0x0001;
+}
+
+/*
+ * Stop the timer started by init_timer2A_periodicInterrupt()
+ */
+void stop_timer2A(void) {
+
+    TIMER2_CTL_R &= ~0x0001;
+    TIMER2_IMR_R &= ~0x01;
+}
+
+void Timer2A_Handler(void) {
+
+    TIMER2_ICR_R = 0x01; //acknowledge the timeout
+    if(timer2ATick)
+        timer2ATick();
+}
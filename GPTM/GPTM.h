@@ -12,5 +12,9 @@ void init_timer0B_PWMperiodic(unsigned int, uint32_t, unsigned int, int);
 void init_timer0B_PWMoneShot(unsigned int, uint32_t, unsigned int, int);
 void init_timer0B_oneShot(int, int, int, int, int);
 void init_timer0B_periodic(int, int, int, int, int);
+void init_timer1A_ADCtrigger(uint32_t);
+void stop_timer1A(void);
+void init_timer2A_periodicInterrupt(uint32_t, int, void (*)(void));
+void stop_timer2A(void);
 
 #endif /* GPTM_H_ */
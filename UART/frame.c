@@ -0,0 +1,299 @@
+#include <inttypes.h>
+#include <stddef.h>
+#include "frame.h"
+
+/* CRC-16/CCITT-FALSE, polynomial 0x1021, one entry per value of the top byte */
+static const uint16_t crcTable[256] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+    0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+    0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+    0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+    0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+    0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+    0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+    0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+    0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+    0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+    0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+    0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+    0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+    0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+    0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+    0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+    0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+    0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+    0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+    0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+    0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+    0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+    0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+    0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+    0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+    0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+    0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+    0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+    0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+    0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+    0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0
+};
+
+/*
+ * Running state of the COBS encoder. code counts the bytes of the block that
+ * is open, and codeIndex is where its code byte goes once the block closes.
+ */
+typedef struct {
+    uint8_t *out;
+    size_t write;
+    size_t codeIndex;
+    uint8_t code;
+} cobsState;
+
+static void cobsStart(cobsState *state, uint8_t *out)
+{
+    state->out = out;
+    state->codeIndex = 0;
+    state->write = 1;
+    state->code = 1;
+}
+
+static void cobsPut(cobsState *state, uint8_t byte)
+{
+    if(byte == 0) {
+        state->out[state->codeIndex] = state->code;
+        state->code = 1;
+        state->codeIndex = state->write++;
+        return;
+    }
+
+    state->out[state->write++] = byte;
+    state->code++;
+
+    /* A block holds at most 254 data bytes */
+    if(state->code == 0xFF) {
+        state->out[state->codeIndex] = state->code;
+        state->code = 1;
+        state->codeIndex = state->write++;
+    }
+}
+
+static size_t cobsFinish(cobsState *state)
+{
+    state->out[state->codeIndex] = state->code;
+    return state->write;
+}
+
+/*
+ * Update a CRC-16/CCITT-FALSE with more data. Start from FRAME_CRC_INIT.
+ */
+uint16_t FRAME_crc16(uint16_t crc, const uint8_t *data, size_t length)
+{
+    size_t i;
+
+    for(i = 0; i < length; i++)
+        crc = (uint16_t)((crc << 8) ^ crcTable[((crc >> 8) ^ data[i]) & 0xFF]);
+
+    return crc;
+}
+
+/*
+ * COBS encode a block of data. No delimiter is added.
+ *
+ * param out:
+ *          Room for at least length + length / 254 + 1 bytes.
+ *
+ * returns:
+ *          The number of bytes written to out.
+ */
+size_t FRAME_cobsEncode(const uint8_t *in, size_t length, uint8_t *out)
+{
+    cobsState state;
+    size_t i;
+
+    cobsStart(&state, out);
+    for(i = 0; i < length; i++)
+        cobsPut(&state, in[i]);
+
+    return cobsFinish(&state);
+}
+
+/*
+ * Build a complete frame, delimiter included, ready to go on the line.
+ *
+ * param seq:
+ *          The sequence number. Give each frame the next number so the
+ *          receiver can count frames it lost.
+ *
+ * param payload, length:
+ *          The data. length may be up to FRAME_MAX_PAYLOAD.
+ *
+ * param out:
+ *          Room for FRAME_ENCODED_SIZE(length) bytes.
+ *
+ * returns:
+ *          The number of bytes written to out, or 0 if the payload is too long.
+ */
+size_t FRAME_encode(uint8_t seq, const uint8_t *payload, size_t length, uint8_t *out)
+{
+    cobsState state;
+    uint16_t crc;
+    size_t i;
+    size_t written;
+
+    if(length > FRAME_MAX_PAYLOAD)
+        return 0;
+
+    crc = FRAME_crc16(FRAME_CRC_INIT, &seq, 1);
+    crc = FRAME_crc16(crc, payload, length);
+
+    cobsStart(&state, out);
+    cobsPut(&state, seq);
+    for(i = 0; i < length; i++)
+        cobsPut(&state, payload[i]);
+    cobsPut(&state, (uint8_t)(crc >> 8));
+    cobsPut(&state, (uint8_t)(crc & 0xFF));
+    written = cobsFinish(&state);
+
+    out[written++] = 0x00;
+    return written;
+}
+
+/*
+ * Reset the receive state. The first frame after this is taken as the
+ * reference for sequence numbers.
+ */
+void FRAME_rxInit(frameRx *rx)
+{
+    rx->length = 0;
+    rx->remaining = 0;
+    rx->zeroPending = 0;
+    rx->discarding = 0;
+    rx->synced = 0;
+    rx->nextSeq = 0;
+    rx->lostFrames = 0;
+    rx->badFrames = 0;
+}
+
+/*
+ * Check the frame that has just been closed by a delimiter.
+ */
+static int FRAME_finish(frameRx *rx)
+{
+    uint16_t crc;
+    size_t length = rx->length;
+    uint8_t seq;
+
+    if(rx->discarding || rx->remaining != 0 || length < 3)
+        return -1;
+
+    crc = FRAME_crc16(FRAME_CRC_INIT, rx->buffer, length - 2);
+    if(crc != (((uint16_t)rx->buffer[length - 2] << 8) | rx->buffer[length - 1]))
+        return -1;
+
+    seq = rx->buffer[0];
+    if(rx->synced)
+        rx->lostFrames += (uint8_t)(seq - rx->nextSeq);
+    rx->synced = 1;
+    rx->nextSeq = (uint8_t)(seq + 1);
+
+    return (int)(length - 3);
+}
+
+/*
+ * Feed one byte from the line into the decoder.
+ *
+ * returns:
+ *          The payload length once a good frame is complete. The payload
+ *          is then at FRAME_payload() until the next byte is fed in.
+ *          0 while a frame is still coming in, or on an empty frame.
+ *          -1 when a frame was dropped because it was damaged.
+ */
+int FRAME_receiveByte(frameRx *rx, uint8_t byte)
+{
+    int result;
+
+    if(byte == 0x00) {
+        if(rx->length == 0 && !rx->discarding && rx->remaining == 0) {
+            return 0; // back to back delimiters
+        }
+        result = FRAME_finish(rx);
+        if(result < 0)
+            rx->badFrames++;
+        rx->length = 0;
+        rx->remaining = 0;
+        rx->zeroPending = 0;
+        rx->discarding = 0;
+        return result;
+    }
+
+    if(rx->discarding)
+        return 0;
+
+    if(rx->remaining == 0) {
+        /* A code byte. The block before it ends in a zero unless it was full */
+        if(rx->zeroPending) {
+            if(rx->length >= sizeof(rx->buffer)) {
+                rx->discarding = 1;
+                return 0;
+            }
+            rx->buffer[rx->length++] = 0x00;
+        }
+        rx->remaining = byte - 1;
+        rx->zeroPending = (byte != 0xFF);
+        return 0;
+    }
+
+    if(rx->length >= sizeof(rx->buffer)) {
+        rx->discarding = 1;
+        return 0;
+    }
+    rx->buffer[rx->length++] = byte;
+    rx->remaining--;
+    return 0;
+}
+
+/* The payload of the frame FRAME_receiveByte() has just completed */
+const uint8_t *FRAME_payload(frameRx *rx)
+{
+    return &rx->buffer[1];
+}
+
+/* The sequence number of the frame FRAME_receiveByte() has just completed */
+uint8_t FRAME_sequence(frameRx *rx)
+{
+    return rx->buffer[0];
+}
+
+#ifndef FRAME_HOST
+/*
+ * Set up framed transmit on a port that has been through UART_init().
+ */
+void FRAME_txInit(frameTx *tx, uartPort *port)
+{
+    tx->port = port;
+    tx->seq = 0;
+}
+
+/*
+ * Encode and send one frame. The frame goes out with uDMA, so this returns
+ * as soon as it is encoded.
+ *
+ * returns:
+ *          0 if the frame was started, -1 if the previous frame is still
+ *          going out or the payload is longer than FRAME_MAX_PAYLOAD.
+ */
+int FRAME_send(frameTx *tx, const uint8_t *payload, size_t length)
+{
+    size_t encoded;
+
+    if(length > FRAME_MAX_PAYLOAD || UART_sendBufferBusy(tx->port))
+        return -1;
+
+    encoded = FRAME_encode(tx->seq, payload, length, tx->buffer);
+    if(UART_sendBuffer(tx->port, tx->buffer, encoded, NULL) != 0)
+        return -1;
+
+    tx->seq++;
+    return 0;
+}
+#endif
@@ -0,0 +1,74 @@
+/*
+ * frame.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: bjh885
+ *
+ * Binary framing on top of the UART driver. Each frame is a sequence number,
+ * the payload and a CRC-16, COBS encoded so that the only zero byte on the
+ * line is the delimiter at the end. A receiver that loses a byte throws away
+ * at most the frame it was in and picks up again at the next zero.
+ *
+ * The encoder and decoder have no hardware dependencies, so frame.c also
+ * builds on a PC to decode captured traffic. Define FRAME_HOST there to leave
+ * out FRAME_send().
+ */
+
+#ifndef FRAME_H_
+#define FRAME_H_
+
+#include <inttypes.h>
+#include <stddef.h>
+
+/* Largest payload a frame carries */
+#define FRAME_MAX_PAYLOAD 250
+
+/*
+ * Bytes on the line for a payload of n bytes: sequence number and CRC, one
+ * COBS code byte per 254 bytes or part of, plus the delimiter.
+ */
+#define FRAME_ENCODED_SIZE(n) ((n) + 3 + ((n) + 3) / 254 + 1 + 1)
+
+/* Initial value of the CRC-16/CCITT-FALSE used on every frame */
+#define FRAME_CRC_INIT 0xFFFF
+
+/*
+ * Receive state. Feed it every byte that comes off the line with
+ * FRAME_receiveByte().
+ */
+typedef struct {
+    uint8_t buffer[FRAME_MAX_PAYLOAD + 3];
+    size_t length;
+    int remaining;          /* bytes left in the current COBS block */
+    int zeroPending;        /* the current block ends in an implied zero */
+    int discarding;         /* overflowed, skip to the next delimiter */
+    int synced;             /* a frame has been seen, so sequence gaps count */
+    uint8_t nextSeq;
+    unsigned long lostFrames;
+    unsigned long badFrames;
+} frameRx;
+
+uint16_t FRAME_crc16(uint16_t, const uint8_t *, size_t);
+size_t FRAME_cobsEncode(const uint8_t *, size_t, uint8_t *);
+size_t FRAME_encode(uint8_t, const uint8_t *, size_t, uint8_t *);
+void FRAME_rxInit(frameRx *);
+int FRAME_receiveByte(frameRx *, uint8_t);
+const uint8_t *FRAME_payload(frameRx *);
+uint8_t FRAME_sequence(frameRx *);
+
+#ifndef FRAME_HOST
+#include "uart.h"
+
+/* Transmit state for one port. The frame is encoded into buffer and sent
+ * from there with uDMA */
+typedef struct {
+    uartPort *port;
+    uint8_t seq;
+    uint8_t buffer[FRAME_ENCODED_SIZE(FRAME_MAX_PAYLOAD)];
+} frameTx;
+
+void FRAME_txInit(frameTx *, uartPort *);
+int FRAME_send(frameTx *, const uint8_t *, size_t);
+#endif
+
+#endif /* FRAME_H_ */
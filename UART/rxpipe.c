@@ -0,0 +1,173 @@
+#include <inttypes.h>
+#include <stddef.h>
+#include <string.h>
+#include "rxpipe.h"
+
+/* Every byte of a word set to b */
+#define BYTES(b) (0x01010101UL * (b))
+
+/*
+ * Words are moved with memcpy so the compiler can use a plain LDR/STR
+ * without breaking aliasing rules.
+ */
+static uint32_t loadWord(const uint8_t *p)
+{
+    uint32_t word;
+    memcpy(&word, p, 4);
+    return word;
+}
+
+static void storeWord(uint8_t *p, uint32_t word)
+{
+    memcpy(p, &word, 4);
+}
+
+/*
+ * Set up a pipeline on a port that is in interrupt mode.
+ */
+void RXPIPE_init(rxPipeline *pipe, uartPort *port)
+{
+    pipe->port = port;
+    pipe->stageCount = 0;
+}
+
+/*
+ * Append a stage. Stages run in the order they were added.
+ *
+ * returns:
+ *          0 on success, -1 if there are already RXPIPE_MAX_STAGES stages.
+ */
+int RXPIPE_addStage(rxPipeline *pipe, rxStage function, void *context)
+{
+    if(pipe->stageCount >= RXPIPE_MAX_STAGES)
+        return -1;
+
+    pipe->stages[pipe->stageCount].function = function;
+    pipe->stages[pipe->stageCount].context = context;
+    pipe->stageCount++;
+    return 0;
+}
+
+/*
+ * Run everything received so far through the stages. Call from the main
+ * loop, never from an interrupt handler.
+ *
+ * returns:
+ *          The number of bytes taken from the port.
+ */
+size_t RXPIPE_poll(rxPipeline *pipe)
+{
+    uint8_t *block = (uint8_t *)pipe->block;
+    size_t total = 0;
+    size_t length;
+    size_t received;
+    int i;
+
+    while((received = UART_read(pipe->port, block, RXPIPE_BLOCK_SIZE)) > 0) {
+        length = received;
+        for(i = 0; i < pipe->stageCount && length > 0; i++)
+            length = pipe->stages[i].function(pipe->stages[i].context, block, length);
+        total += received;
+    }
+
+    return total;
+}
+
+/*
+ * Fold 'a' to 'z' to upper case, the same as ToUpperCase() but a word at a
+ * time. With the top bit of each byte masked off, adding 0x1F sets it for
+ * bytes >= 'a' and adding 0x05 sets it for bytes > 'z'. Neither sum can
+ * carry into the next byte. Bytes that had the top bit set to begin with
+ * are left alone. The bytes that pass get 0x20 cleared.
+ */
+size_t RXPIPE_toUpper(void *context, uint8_t *data, size_t length)
+{
+    size_t i = 0;
+    uint32_t word;
+    uint32_t low;
+    uint32_t lower;
+
+    (void)context; // no state, the stage is the same for every pipeline
+
+    for(; i + 4 <= length; i += 4) {
+        word = loadWord(&data[i]);
+        low = word & BYTES(0x7F);
+        lower = (low + BYTES(0x1F)) & ~(low + BYTES(0x05)) & ~word & BYTES(0x80);
+        storeWord(&data[i], word ^ (lower >> 2));
+    }
+    for(; i < length; i++)
+        data[i] = ToUpperCase(data[i]);
+
+    return length;
+}
+
+/*
+ * Add every byte into a 16-bit sum. The bytes of a word are added in pairs
+ * into two 16-bit lanes, which are folded together every 128 words before
+ * they can overflow.
+ */
+size_t RXPIPE_checksum(void *context, uint8_t *data, size_t length)
+{
+    rxChecksum *checksum = (rxChecksum *)context;
+    uint32_t lanes = 0;
+    uint32_t word;
+    uint16_t sum = checksum->sum;
+    size_t i = 0;
+    int words = 0;
+
+    for(; i + 4 <= length; i += 4) {
+        word = loadWord(&data[i]);
+        lanes += (word & 0x00FF00FF) + ((word >> 8) & 0x00FF00FF);
+        if(++words == 128) {
+            sum += (uint16_t)((lanes & 0xFFFF) + (lanes >> 16));
+            lanes = 0;
+            words = 0;
+        }
+    }
+    sum += (uint16_t)((lanes & 0xFFFF) + (lanes >> 16));
+    for(; i < length; i++)
+        sum += data[i];
+
+    checksum->sum = sum;
+    return length;
+}
+
+/*
+ * Split the stream into lines on '\n'. Words without a newline are copied
+ * whole; the usual "has a zero byte" test on word ^ 0x0A0A0A0A finds the
+ * ones that have one. A line longer than RXPIPE_MAX_LINE - 1 is handed over
+ * in pieces. Leaves the block unchanged for the next stage.
+ */
+size_t RXPIPE_lines(void *context, uint8_t *data, size_t length)
+{
+    rxLines *lines = (rxLines *)context;
+    size_t i = 0;
+    uint32_t word;
+
+    while(i < length) {
+        if(i + 4 <= length && lines->length + 4 < RXPIPE_MAX_LINE) {
+            word = loadWord(&data[i]) ^ BYTES('\n');
+            if(((word - BYTES(0x01)) & ~word & BYTES(0x80)) == 0) {
+                memcpy(&lines->line[lines->length], &data[i], 4);
+                lines->length += 4;
+                i += 4;
+                continue;
+            }
+        }
+
+        if(data[i] == '\n' || lines->length == RXPIPE_MAX_LINE - 1) {
+            lines->line[lines->length] = '\0';
+            if(lines->lineDone)
+                lines->lineDone(lines->line, lines->length);
+            lines->length = 0;
+            if(data[i] != '\n')
+                continue; // the byte starts the next piece
+        }
+        else {
+            lines->line[lines->length++] = (char)data[i];
+        }
+        i++;
+    }
+
+    return length;
+}
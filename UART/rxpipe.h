@@ -0,0 +1,68 @@
+/*
+ * rxpipe.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: bjh885
+ *
+ * Block based processing of received data. RXPIPE_poll() takes whatever the
+ * UART interrupt handler has collected and runs it through a list of stages,
+ * so the work happens in the main loop rather than in the handler. The
+ * stages provided here handle 4 bytes per 32-bit word (SWAR) and only fall
+ * back to single bytes for the ragged end of a block.
+ */
+
+#ifndef RXPIPE_H_
+#define RXPIPE_H_
+
+#include <inttypes.h>
+#include <stddef.h>
+#include "uart.h"
+
+#define RXPIPE_MAX_STAGES 4
+
+/* Bytes taken from the port per pass. A multiple of 4 */
+#define RXPIPE_BLOCK_SIZE 64
+
+/* Longest line RXPIPE_lines() will hold, terminator included */
+#define RXPIPE_MAX_LINE 80
+
+/*
+ * A stage works on a block in place and returns how many bytes it leaves for
+ * the next stage. The block always starts on a word boundary.
+ */
+typedef size_t (*rxStage)(void *, uint8_t *, size_t);
+
+typedef struct {
+    rxStage function;
+    void *context;
+} rxStageEntry;
+
+typedef struct {
+    uartPort *port;
+    rxStageEntry stages[RXPIPE_MAX_STAGES];
+    int stageCount;
+    uint32_t block[RXPIPE_BLOCK_SIZE / 4];
+} rxPipeline;
+
+/* Context for RXPIPE_checksum(). sum is the 16-bit sum of every byte seen */
+typedef struct {
+    uint16_t sum;
+} rxChecksum;
+
+/* Context for RXPIPE_lines(). lineDone is called with each full line,
+ * without the '\n' and with a '\0' after it */
+typedef struct {
+    char line[RXPIPE_MAX_LINE];
+    size_t length;
+    void (*lineDone)(char *, size_t);
+} rxLines;
+
+void RXPIPE_init(rxPipeline *, uartPort *);
+int RXPIPE_addStage(rxPipeline *, rxStage, void *);
+size_t RXPIPE_poll(rxPipeline *);
+
+size_t RXPIPE_toUpper(void *, uint8_t *, size_t);
+size_t RXPIPE_checksum(void *, uint8_t *, size_t);
+size_t RXPIPE_lines(void *, uint8_t *, size_t);
+
+#endif /* RXPIPE_H_ */
@@ -0,0 +1,176 @@
+#include <inttypes.h>
+#include <stddef.h>
+#include <string.h>
+#include "trace.h"
+
+#if (TRACE_BUFFER_WORDS & (TRACE_BUFFER_WORDS - 1))
+#error "TRACE_BUFFER_WORDS must be a power of two"
+#endif
+
+#ifndef TRACE_HOST
+
+/*
+ * Records may be written from main and from any interrupt handler, so a
+ * record is reserved and filled with interrupts masked. That is a handful of
+ * cycles, far less than formatting the text would take.
+ */
+#if defined(__TI_COMPILER_VERSION__)
+#define TRACE_LOCK()            _disable_interrupts()
+#define TRACE_UNLOCK(state)     _restore_interrupts(state)
+#else
+static inline uint32_t TRACE_LOCK(void)
+{
+    uint32_t primask;
+    __asm volatile ("mrs %0, primask\n\tcpsid i" : "=r" (primask) : : "memory");
+    return primask;
+}
+#define TRACE_UNLOCK(state)     __asm volatile ("msr primask, %0" : : "r" (state) : "memory")
+#endif
+
+static uint32_t traceBuffer[TRACE_BUFFER_WORDS];
+static volatile unsigned int traceHead;
+static volatile unsigned int traceTail;
+static unsigned long traceDropped;
+static unsigned long traceDroppedTotal;
+
+/*
+ * Store one record. Use the TRACEn() macros rather than calling this. If the
+ * buffer is full the record is dropped and counted, and the count is sent
+ * as a TRACE_DROPPED record with the next flush.
+ */
+void TRACE_write(uint32_t header, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3)
+{
+    unsigned int count = header & 0xFFFF;
+    unsigned int head;
+    uint32_t state;
+
+    state = TRACE_LOCK();
+    head = traceHead;
+    if(TRACE_BUFFER_WORDS - (head - traceTail) < count + 1) {
+        traceDropped++;
+        TRACE_UNLOCK(state);
+        return;
+    }
+
+    traceBuffer[head & (TRACE_BUFFER_WORDS - 1)] = header;
+    switch(count) {
+        case 4: traceBuffer[(head + 4) & (TRACE_BUFFER_WORDS - 1)] = a3;
+        case 3: traceBuffer[(head + 3) & (TRACE_BUFFER_WORDS - 1)] = a2;
+        case 2: traceBuffer[(head + 2) & (TRACE_BUFFER_WORDS - 1)] = a1;
+        case 1: traceBuffer[(head + 1) & (TRACE_BUFFER_WORDS - 1)] = a0;
+        default: break;
+    }
+    traceHead = head + count + 1;
+    TRACE_UNLOCK(state);
+}
+
+/*
+ * Send as many whole records as fit in one frame. Call from the main loop
+ * or a low priority timer. Only one frame is in flight at a time, so call
+ * it often enough to keep up with the rate records are written.
+ *
+ * returns:
+ *          The number of records sent, 0 if there was nothing to send or
+ *          the port is still busy with the previous frame.
+ */
+int TRACE_flush(frameTx *tx)
+{
+    uint32_t words[FRAME_MAX_PAYLOAD / 4];
+    unsigned int used = 0;
+    unsigned int tail = traceTail;
+    unsigned int head = traceHead;
+    unsigned int count;
+    unsigned int i;
+    int records = 0;
+    uint32_t state;
+
+    if(UART_sendBufferBusy(tx->port))
+        return 0;
+
+    state = TRACE_LOCK();
+    if(traceDropped) {
+        words[used++] = TRACE_HEADER(TRACE_DROPPED, 1);
+        words[used++] = traceDropped;
+        traceDroppedTotal += traceDropped;
+        traceDropped = 0;
+        records++;
+    }
+    TRACE_UNLOCK(state);
+
+    while(tail != head) {
+        count = (traceBuffer[tail & (TRACE_BUFFER_WORDS - 1)] & 0xFFFF) + 1;
+        if(used + count > sizeof(words) / sizeof(words[0]))
+            break;
+        for(i = 0; i < count; i++)
+            words[used++] = traceBuffer[(tail + i) & (TRACE_BUFFER_WORDS - 1)];
+        tail += count;
+        records++;
+    }
+
+    if(used == 0)
+        return 0;
+
+    /* Little endian on the line, the same as memory on the TM4C */
+    if(FRAME_send(tx, (const uint8_t *)words, used * 4) != 0)
+        return 0;
+
+    traceTail = tail;
+    return records;
+}
+
+/* The number of records lost to a full buffer since start up */
+unsigned long TRACE_dropped(void)
+{
+    return traceDroppedTotal + traceDropped;
+}
+
+#else
+
+/* The formats, in event ID order */
+#define TRACE_EVENT(name, format) format,
+static const char *traceFormats[] = {
+#include "trace_events.h"
+};
+#undef TRACE_EVENT
+
+/*
+ * Print the records in one frame payload, one line each. Feed it the
+ * payloads FRAME_receiveByte() returns from the capture.
+ */
+void TRACE_decode(const uint8_t *payload, size_t length, FILE *out)
+{
+    uint32_t words[FRAME_MAX_PAYLOAD / 4];
+    uint32_t args[4];
+    size_t count = length / 4;
+    size_t i = 0;
+    unsigned int id;
+    unsigned int argCount;
+    unsigned int j;
+
+    if(count > sizeof(words) / sizeof(words[0]))
+        count = sizeof(words) / sizeof(words[0]);
+    for(j = 0; j < count; j++) {
+        words[j] = (uint32_t)payload[4 * j] | ((uint32_t)payload[4 * j + 1] << 8) |
+                   ((uint32_t)payload[4 * j + 2] << 16) | ((uint32_t)payload[4 * j + 3] << 24);
+    }
+
+    while(i < count) {
+        id = words[i] >> 16;
+        argCount = words[i] & 0xFFFF;
+        if(argCount > 4 || i + 1 + argCount > count) {
+            fprintf(out, "trace: bad record header 0x%08lx\n", (unsigned long)words[i]);
+            return;
+        }
+        for(j = 0; j < 4; j++)
+            args[j] = (j < argCount) ? words[i + 1 + j] : 0;
+
+        if(id < TRACE_EVENT_COUNT)
+            fprintf(out, traceFormats[id], args[0], args[1], args[2], args[3]);
+        else
+            fprintf(out, "trace: unknown event %u", id);
+        fputc('\n', out);
+        i += 1 + argCount;
+    }
+}
+
+#endif
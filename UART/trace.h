@@ -0,0 +1,56 @@
+/*
+ * trace.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: bjh885
+ *
+ * Deferred-format trace logging. A trace call only stores the event ID and
+ * its raw argument words in a RAM ring buffer, which is safe and cheap from
+ * an interrupt handler. TRACE_flush() sends the buffer out in frames (see
+ * frame.h) from the main loop, and the host turns the IDs back into text
+ * with the formats in trace_events.h.
+ *
+ * Build trace.c on a PC with -DTRACE_HOST -DFRAME_HOST to get the decoder
+ * instead of the logging side.
+ */
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <inttypes.h>
+#include <stddef.h>
+#include "frame.h"
+
+/* Size of the ring buffer in 32-bit words. Must be a power of two */
+#define TRACE_BUFFER_WORDS 256
+
+#define TRACE_EVENT(name, format) name,
+enum traceEvents {
+#include "trace_events.h"
+    TRACE_EVENT_COUNT
+};
+#undef TRACE_EVENT
+
+/*
+ * First word of each record: the event ID in the top half and the number of
+ * argument words that follow in the bottom half.
+ */
+#define TRACE_HEADER(id, count) (((uint32_t)(id) << 16) | (count))
+
+#define TRACE0(id)             TRACE_write(TRACE_HEADER(id, 0), 0, 0, 0, 0)
+#define TRACE1(id, a)          TRACE_write(TRACE_HEADER(id, 1), (uint32_t)(a), 0, 0, 0)
+#define TRACE2(id, a, b)       TRACE_write(TRACE_HEADER(id, 2), (uint32_t)(a), (uint32_t)(b), 0, 0)
+#define TRACE3(id, a, b, c)    TRACE_write(TRACE_HEADER(id, 3), (uint32_t)(a), (uint32_t)(b), (uint32_t)(c), 0)
+#define TRACE4(id, a, b, c, d) TRACE_write(TRACE_HEADER(id, 4), (uint32_t)(a), (uint32_t)(b), (uint32_t)(c), (uint32_t)(d))
+
+#ifndef TRACE_HOST
+void TRACE_write(uint32_t, uint32_t, uint32_t, uint32_t, uint32_t);
+int TRACE_flush(frameTx *);
+unsigned long TRACE_dropped(void);
+#else
+#include <stdio.h>
+
+void TRACE_decode(const uint8_t *, size_t, FILE *);
+#endif
+
+#endif /* TRACE_H_ */
@@ -0,0 +1,18 @@
+/*
+ * trace_events.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: bjh885
+ *
+ * The list of trace events. Each line gives the event name used in the code
+ * and the printf format the host prints it with. Arguments are 32-bit words,
+ * at most four per event. This file is included once by the target, where it
+ * becomes the event IDs, and once by the host decoder, where it becomes the
+ * string table, so the two always agree. Only add to the end, so old
+ * captures still decode.
+ *
+ * No include guard on purpose.
+ */
+
+TRACE_EVENT(TRACE_DROPPED, "trace: %u records dropped")
+TRACE_EVENT(TRACE_MARK, "mark %u")
@@ -1,9 +1,210 @@
 #include "tm4c123gh6pm.h"
 #include <stdlib.h>
-#include <math.h>
+#include <inttypes.h>
+#include <string.h>
+#include "uart.h"
+#include "UDMA/udma.h"
+
+#if (UART_TX_BUFFER_SIZE & (UART_TX_BUFFER_SIZE - 1)) || \
+    (UART_RX_BUFFER_SIZE & (UART_RX_BUFFER_SIZE - 1))
+#error "UART buffer sizes must be a power of two"
+#endif
+
+/* Register offsets within a UART block */
+#define UART_O_DR        0x000
+#define UART_O_RSR       0x004
+#define UART_O_ECR       0x004
+#define UART_O_FR        0x018
+#define UART_O_IBRD      0x024
+#define UART_O_FBRD      0x028
+#define UART_O_LCRH      0x02C
+#define UART_O_CTL       0x030
+#define UART_O_IFLS      0x034
+#define UART_O_IM        0x038
+#define UART_O_MIS       0x040
+#define UART_O_ICR       0x044
+#define UART_O_DMACTL    0x048
+#define UART_O_9BITADDR  0x0A4
+#define UART_O_9BITAMASK 0x0A8
+
+/* Register offsets within a GPIO block */
+#define GPIO_O_AFSEL     0x420
+#define GPIO_O_DEN       0x51C
+#define GPIO_O_LOCK      0x520
+#define GPIO_O_CR        0x524
+#define GPIO_O_AMSEL     0x528
+#define GPIO_O_PCTL      0x52C
+
+#ifdef UART_HOST
+/*
+ * Host tests build this file against a simulated UART, see host/uart_sim.h.
+ * Every register access goes through the simulator so that reading DR pops
+ * its FIFO and FR/MIS reflect its state.
+ */
+volatile unsigned long *UART_hostRegister(unsigned long base, unsigned long offset);
+void UART_hostPend(int irq);
+#define UART_REG(port, offset) (*UART_hostRegister((port)->hw->base, (offset)))
+#define UART_PEND(port) UART_hostPend((port)->hw->irq)
+#else
+#define UART_REG(port, offset) (*((volatile unsigned long *)((port)->hw->base + (offset))))
+#define UART_PEND(port) (NVIC_SW_TRIG_R = (port)->hw->irq) // p.144
+#endif
+#define GPIO_REG(base, offset) (*((volatile unsigned long *)((base) + (offset))))
+
+const uartInstance UART0_PA0_PA1 = {0, 0x4000C000, 5, 9, 0, 0x40004000, 0x01, 0x03, 0x00000011};
+const uartInstance UART1_PB0_PB1 = {1, 0x4000D000, 6, 23, 0, 0x40005000, 0x02, 0x03, 0x00000011};
+const uartInstance UART1_PC4_PC5 = {1, 0x4000D000, 6, 23, 0, 0x40006000, 0x04, 0x30, 0x00220000};
+const uartInstance UART1_PB0_PB1_RTS_PC4_CTS_PC5 = {1, 0x4000D000, 6, 23, 0, 0x40005000, 0x02, 0x03, 0x00000011,
+                                                    0x40006000, 0x04, 0x30, 0x00880000};
+const uartInstance UART2_PD6_PD7 = {2, 0x4000E000, 33, 13, 1, 0x40007000, 0x08, 0xC0, 0x11000000};
+const uartInstance UART3_PC6_PC7 = {3, 0x4000F000, 59, 17, 2, 0x40006000, 0x04, 0xC0, 0x11000000};
+const uartInstance UART4_PC4_PC5 = {4, 0x40010000, 60, 19, 2, 0x40006000, 0x04, 0x30, 0x00110000};
+const uartInstance UART5_PE4_PE5 = {5, 0x40011000, 61, 7, 2, 0x40024000, 0x10, 0x30, 0x00110000};
+const uartInstance UART6_PD4_PD5 = {6, 0x40012000, 62, 11, 2, 0x40007000, 0x08, 0x30, 0x00110000};
+const uartInstance UART7_PE0_PE1 = {7, 0x40013000, 63, 21, 2, 0x40024000, 0x10, 0x03, 0x00000011};
+
+/* The port each UARTn_Handler() serves, filled in by UART_init() */
+static uartPort *uartPorts[8];
+
+/* The port behind the UART1_ functions */
+static uartPort uart1;
+
+/*
+ * Pick the divisor for a baud rate. With allowHse, the /8 divisor (HSE) is
+ * used whenever it lands closer to the wanted baud rate than /16, or when
+ * the baud rate is too high for /16 at all. Exits if neither divisor fits.
+ */
+static void UART_setDivisor(uartPort *port, int baud, int clk, int allowHse)
+{
+    uint32_t clkHz = (uint32_t)clk * 1000000;
+    uint32_t brd16 = UART_BRD_X64(clkHz, (uint32_t)baud, 16); //Calculate the baud rate. Formula on Pg. 845
+    uint32_t brd8 = UART_BRD_X64(clkHz, (uint32_t)baud, 8);
+    uint32_t error16 = 0xFFFFFFFF;
+    uint32_t error8 = 0xFFFFFFFF;
+    uint32_t actual;
+
+    /* IBRD is 16 bits and may not be zero */
+    if((brd16 >> 6) != 0 && (brd16 >> 6) <= 0xFFFF) {
+        actual = (clkHz * 4 + brd16 / 2) / brd16;
+        error16 = (actual > (uint32_t)baud) ? actual - baud : baud - actual;
+    }
+    if(allowHse && (brd8 >> 6) != 0 && (brd8 >> 6) <= 0xFFFF) {
+        actual = (clkHz * 8 + brd8 / 2) / brd8;
+        error8 = (actual > (uint32_t)baud) ? actual - baud : baud - actual;
+    }
+
+    if(error16 == 0xFFFFFFFF && error8 == 0xFFFFFFFF)
+        exit(EXIT_FAILURE);
+
+    if(error8 < error16) {
+        UART_REG(port, UART_O_CTL) |= 0x20; // p.868, HSE, divide by 8
+        UART_REG(port, UART_O_IBRD) = brd8 >> 6;
+        UART_REG(port, UART_O_FBRD) = brd8 & 0x3F;
+    }
+    else {
+        UART_REG(port, UART_O_CTL) &= ~0x20;
+        UART_REG(port, UART_O_IBRD) = brd16 >> 6;
+        UART_REG(port, UART_O_FBRD) = brd16 & 0x3F;
+    }
+}
+
+/*
+ * Hand a set of pins on one GPIO port over to a UART.
+ */
+static void UART_muxPins(unsigned long gpioBase, unsigned int gpioClock, unsigned int pins, unsigned long pctl)
+{
+    volatile unsigned long delay_clk;
+    unsigned long pctlMask = 0;
+    int pin;
+
+    SYSCTL_RCGC2_R |= gpioClock; // p.424, activate clock gating for the port
+    delay_clk = SYSCTL_RCGC2_R; // dummy operation for clock to settle
+
+    /* PD7 is locked as an NMI pin. Unlocking costs nothing elsewhere */
+    GPIO_REG(gpioBase, GPIO_O_LOCK) = 0x4C4F434B;
+    GPIO_REG(gpioBase, GPIO_O_CR) |= pins;
+
+    for(pin = 0; pin < 8; pin++) {
+        if(pins & (1 << pin))
+            pctlMask |= 0xFUL << (pin * 4);
+    }
+
+    GPIO_REG(gpioBase, GPIO_O_AMSEL) &= ~pins; // no analog on the UART pins
+    GPIO_REG(gpioBase, GPIO_O_AFSEL) |= pins; // p.624, enable alternate function
+    GPIO_REG(gpioBase, GPIO_O_DEN) |= pins; // p.636, enable DEN
+    GPIO_REG(gpioBase, GPIO_O_PCTL) = (GPIO_REG(gpioBase, GPIO_O_PCTL) & ~pctlMask) | pctl; // pg.1135
+// GPIO DIR is not needed since inputs and outputs for uart pins are predefined in table 14-1
+}
 
 /*
- * Initialise uart1.
+ * Common part of UART_init() and UART_initHighSpeed().
+ */
+static void UART_setup(uartPort *port, const uartInstance *hw, int baud, int clk, int allowHse)
+{
+    volatile unsigned long delay_clk;
+
+    port->hw = hw;
+    port->interruptMode = 0;
+    port->txHead = port->txTail = 0;
+    port->rxHead = port->rxTail = 0;
+    port->txDmaArb = UDMA_CHCTL_ARBSIZE_8; // 8 free at the default 1/2 TX level
+    port->overrunErrors = 0;
+    port->framingErrors = 0;
+    port->dmaBusy = 0;
+    uartPorts[hw->number] = port;
+
+    SYSCTL_RCGCUART_R |= 1UL << hw->number; // activate the UART
+    delay_clk = SYSCTL_RCGCUART_R; // dummy operation for clock to settle
+
+    UART_REG(port, UART_O_CTL) &= ~0x01; // p.868, disable the UART during config
+
+    UART_setDivisor(port, baud, clk, allowHse);
+    UART_REG(port, UART_O_LCRH) |= 0x60; // p.866, word length 8 bit, all other default, 8N1
+
+    /*
+     * With RTSEN, RTS is dropped once the RX FIFO fills, and with CTSEN
+     * nothing is sent while the far end holds CTS off, p.868.
+     */
+    if(hw->flowPins)
+        UART_REG(port, UART_O_CTL) |= 0xC000;
+    else
+        UART_REG(port, UART_O_CTL) &= ~0xC000;
+
+    UART_REG(port, UART_O_ECR) = 0; // p.864, clear any old receive errors
+    UART_REG(port, UART_O_CTL) |= 0x01; // Enable the UART after config
+
+    UART_muxPins(hw->gpioBase, hw->gpioClock, hw->gpioPins, hw->pctl);
+    if(hw->flowPins)
+        UART_muxPins(hw->flowGpioBase, hw->flowGpioClock, hw->flowPins, hw->flowPctl);
+}
+
+/*
+ * Count the errors flagged on a received character. The flags sit in bits
+ * 11:8 of DR, p.862. An overrun is counted from RSR instead, since it is
+ * raised as soon as a byte is lost rather than with a later character.
+ */
+static void UART_countErrors(uartPort *port, unsigned long data)
+{
+    if(data & 0x100) // FE
+        port->framingErrors++;
+
+    if(UART_REG(port, UART_O_RSR) & 0x08) { // p.864, OE
+        port->overrunErrors++;
+        UART_REG(port, UART_O_ECR) = 0;
+    }
+}
+
+/*
+ * Initialise a UART as 8N1 and mux it onto its pins.
+ *
+ * param port:
+ *          State for this port. Must stay around for as long as the port is
+ *          used, since the interrupt handler works on it.
+ *
+ * param hw:
+ *          Which UART and pins to use, e.g. &UART0_PA0_PA1. Instances with
+ *          RTS and CTS pins, like &UART1_PB0_PB1_RTS_PC4_CTS_PC5, turn on
+ *          hardware flow control as well.
  *
  * param baud:
  *          The baud rate
@@ -11,63 +212,475 @@
  * param clk:
  *          The bus frequency being used in MHz. Enter numbers like, 8, 16, or
  *          80.
+ *
+ * The divisor is worked out with integer math only. Use UART_BAUD_ASSERT()
+ * from uart.h to catch a clock/baud pair that is too far off at build time.
  */
-void UART1_init(int baud, int clk)
+void UART_init(uartPort *port, const uartInstance *hw, int baud, int clk)
+{
+    UART_setup(port, hw, baud, clk, 0);
+}
+
+/*
+ * Same as UART_init(), but the /8 divisor (HSE) is chosen whenever it gives
+ * a smaller baud error than /16. That allows baud rates up to clk / 8, at the
+ * cost of the receiver sampling each bit 8 times instead of 16.
+ */
+void UART_initHighSpeed(uartPort *port, const uartInstance *hw, int baud, int clk)
+{
+    UART_setup(port, hw, baud, clk, 1);
+}
+
+/*
+ * Set the FIFO levels at which the RX and TX interrupts (and uDMA burst
+ * requests) fire, p.870. A high RX level means one interrupt per burst
+ * instead of one per byte. The receive time-out interrupt, enabled by
+ * UART_interrupt(), picks up whatever is left below the level once the
+ * line goes quiet.
+ *
+ * param rxLevel:
+ *          Interrupt once the RX FIFO holds at least this many eighths.
+ *          1, 2, 4, 6 or 7. 4 is the reset value.
+ *
+ * param txLevel:
+ *          Interrupt once the TX FIFO holds at most this many eighths.
+ *          1, 2, 4, 6 or 7. 4 is the reset value.
+ */
+void UART_fifoLevels(uartPort *port, int rxLevel, int txLevel)
 {
-    SYSCTL_RCGC1_R |= 0x02; // p.421, activate UART1
-    SYSCTL_RCGC2_R |= 0x02; // p.424, activate clock gating for Port B
+    /* IFLS encoding for 0 to 7 eighths. -1 is not a valid level */
+    static const int levels[8] = {-1, 0, 1, -1, 2, -1, 3, 4};
+    int freeSlots;
+
+    if(rxLevel < 1 || rxLevel > 7 || txLevel < 1 || txLevel > 7 ||
+       levels[rxLevel] < 0 || levels[txLevel] < 0)
+        exit(EXIT_FAILURE);
 
-    UART1_CTL_R &= ~0x01; // p.868, disable UART1 during config
+    UART_REG(port, UART_O_IFLS) = (levels[rxLevel] << 3) | levels[txLevel];
 
-    double IB;
-    /* Check ISE bit */
-    if(UART1_CTL_R & 0x20)
-        IB = (clk * 1E6)/8/baud; //Calculate the baud rate. Formula on Pg. 845
+    /* A TX burst must fit in what is free at the trigger level */
+    freeSlots = 16 - 2 * txLevel;
+    if(freeSlots >= 8)
+        port->txDmaArb = UDMA_CHCTL_ARBSIZE_8;
+    else if(freeSlots >= 4)
+        port->txDmaArb = UDMA_CHCTL_ARBSIZE_4;
     else
-        IB = (clk * 1E6)/16/baud;
-    int IB_whole = IB; //Truncate off the decimal.
-    float FB = IB - IB_whole; //obtain the decimal portion
-
-    //Convert the fraction into binary with 8 bits of precision.
-    int i;
-    unsigned int FB_whole;
-    int bin = 0;
-    for(i = 7; i >=0; i--) {
-
-        FB = FB * 2;
-        FB_whole = FB; //integer truncation
-        if(FB_whole != 0) {
-            bin = bin + pow(2, i);
-            FB = FB - FB_whole;
+        port->txDmaArb = UDMA_CHCTL_ARBSIZE_2;
+}
+
+/*
+ * Switch a port to interrupt mode. Call after UART_init(). Transmit and
+ * receive go through the port's software ring buffers from then on, so
+ * UART_trySend() and UART_tryRecieve() never wait on the hardware.
+ * UART_send() and UART_recieve() keep working, but block on the ring
+ * buffers instead of the FIFO flags.
+ *
+ * param pri:
+ *          The priority of the interrupt, from 0 to 7. The lower the number,
+ *          the higher the priority.
+ */
+void UART_interrupt(uartPort *port, int pri)
+{
+    int irq = port->hw->irq;
+    volatile unsigned long *nvicPri = &NVIC_PRI0_R + (irq / 4);
+    int shift = (irq % 4) * 8 + 5; // 4n+m, bits 7:5 of byte m
+
+    UART_REG(port, UART_O_IM) &= ~0x470; // p.871, disable overrun, RX, TX and RX time-out interrupts during setup
+
+    port->txHead = port->txTail = 0;
+    port->rxHead = port->rxTail = 0;
+
+    UART_REG(port, UART_O_CTL) &= ~0x01; // p.868, FEN may only be changed while disabled
+    UART_REG(port, UART_O_LCRH) |= 0x10; // p.866, enable the 16 byte hardware FIFOs
+    UART_REG(port, UART_O_CTL) |= 0x01;
+
+    UART_REG(port, UART_O_ICR) = 0x470; // p.883, clear anything left pending
+    UART_REG(port, UART_O_IM) |= 0x470; // OEIM, RXIM, TXIM and RTIM. RTIM catches bytes below the RX trigger level
+
+    *nvicPri = (*nvicPri & ~(0x7UL << shift)) | ((unsigned long)pri << shift);
+    (&NVIC_EN0_R)[irq / 32] = 1UL << (irq % 32);
+    port->interruptMode = 1;
+}
+
+/*
+ * Move bytes from the TX ring buffer into the hardware FIFO until one of them
+ * is full or empty. Only ever called with TXIM masked or from the handler, so
+ * there is only ever one consumer of the TX ring buffer at a time.
+ */
+static void UART_fillTxFifo(uartPort *port)
+{
+    while((port->txHead != port->txTail) && ((UART_REG(port, UART_O_FR) & 0x20) == 0)) {
+        UART_REG(port, UART_O_DR) = port->txBuffer[port->txTail & (UART_TX_BUFFER_SIZE - 1)];
+        port->txTail++;
+    }
+}
+
+/*
+ * Point the TX channel at the next chunk of the caller's buffer. The
+ * arbitration size keeps each burst inside the free space of the hardware
+ * FIFO at its trigger level.
+ */
+static void UART_startTxChunk(uartPort *port)
+{
+    size_t count = port->dmaRemaining;
+
+    if(count > UDMA_MAX_TRANSFER)
+        count = UDMA_MAX_TRANSFER;
+
+    UDMA_setTransfer(port->hw->txDmaChannel, 0, port->dmaNext, &UART_REG(port, UART_O_DR),
+                     UDMA_CHCTL_DSTINC_NONE | UDMA_CHCTL_DSTSIZE_8 |
+                     UDMA_CHCTL_SRCINC_8 | UDMA_CHCTL_SRCSIZE_8 |
+                     port->txDmaArb |
+                     ((count - 1) << UDMA_CHCTL_XFERSIZE_S) |
+                     UDMA_CHCTL_XFERMODE_BASIC);
+    port->dmaNext += count;
+    port->dmaRemaining -= count;
+    UDMA_enable(port->hw->txDmaChannel);
+}
+
+/*
+ * Interrupt body shared by every UART. Fills the RX ring buffer from the
+ * hardware FIFO and refills the hardware FIFO from the TX ring buffer. If the
+ * RX ring buffer is full, the bytes stay in the hardware FIFO until there is
+ * room. Also chains and finishes UART_sendBuffer() transfers.
+ */
+static void UART_handler(uartPort *port)
+{
+    unsigned long data;
+
+    if(port->dmaBusy && UDMA_isDone(port->hw->txDmaChannel)) {
+        if(port->dmaRemaining > 0) {
+            UART_startTxChunk(port);
+        }
+        else {
+            UART_REG(port, UART_O_DMACTL) &= ~0x02; // p.885, TXDMAE
+            port->dmaBusy = 0;
+            if(port->dmaCallback)
+                port->dmaCallback();
         }
     }
 
-    UART1_IBRD_R = IB_whole;
-    UART1_FBRD_R = bin;
-    UART1_LCRH_R |= 0x60; // p.866, word length 8 bit, all other default, 8N1
-    UART1_CTL_R |= 0x01; // Enable UART1 after config
+    if(UART_REG(port, UART_O_MIS) & 0x450) // OEMIS, RXMIS or RTMIS
+        UART_REG(port, UART_O_ICR) = 0x450;
+
+    /*
+     * Drain on every entry, not just when RXMIS or RTMIS is set.
+     * UART_tryRecieve() and UART_read() pend this handler from software for
+     * bytes that were left behind while the ring buffer was full, and by then
+     * nothing new has crossed the trigger level to set RXRIS again. Under
+     * RTS/CTS the sender is held off, so no new edge would ever come.
+     */
+    if(port->interruptMode) {
+        while(((UART_REG(port, UART_O_FR) & 0x10) == 0) &&
+              ((port->rxHead - port->rxTail) < UART_RX_BUFFER_SIZE)) {
+            data = UART_REG(port, UART_O_DR);
+            if(data & 0xF00)
+                UART_countErrors(port, data);
+            port->rxBuffer[port->rxHead & (UART_RX_BUFFER_SIZE - 1)] = (unsigned char)(data & 0xFF);
+            port->rxHead++;
+        }
+        if(UART_REG(port, UART_O_RSR) & 0x08) // overrun with nothing left to read
+            UART_countErrors(port, 0);
+    }
+
+    if(UART_REG(port, UART_O_MIS) & 0x20) { // TXMIS
+        UART_REG(port, UART_O_ICR) = 0x20;
+        UART_fillTxFifo(port);
+    }
+}
+
+/* Vector table entries. Each one only looks up its port */
+void UART0_Handler(void) { UART_handler(uartPorts[0]); }
+void UART1_Handler(void) { UART_handler(uartPorts[1]); }
+void UART2_Handler(void) { UART_handler(uartPorts[2]); }
+void UART3_Handler(void) { UART_handler(uartPorts[3]); }
+void UART4_Handler(void) { UART_handler(uartPorts[4]); }
+void UART5_Handler(void) { UART_handler(uartPorts[5]); }
+void UART6_Handler(void) { UART_handler(uartPorts[6]); }
+void UART7_Handler(void) { UART_handler(uartPorts[7]); }
+
+/*
+ * Queue a character for transmission without waiting.
+ *
+ * returns:
+ *          0 if the character was queued, -1 if the TX buffer is full and
+ *          the call would block.
+ */
+int UART_trySend(uartPort *port, unsigned char uartSendData)
+{
+    if(port->dmaBusy || (port->txHead - port->txTail) >= UART_TX_BUFFER_SIZE)
+        return -1;
+
+    port->txBuffer[port->txHead & (UART_TX_BUFFER_SIZE - 1)] = uartSendData;
+    port->txHead++;
+
+    /*
+     * The TX interrupt only fires when the hardware FIFO drains past its
+     * trigger level, so an idle transmitter has to be primed here. Masking
+     * TXIM keeps the handler from consuming at the same time.
+     */
+    UART_REG(port, UART_O_IM) &= ~0x20;
+    UART_fillTxFifo(port);
+    UART_REG(port, UART_O_IM) |= 0x20;
+
+    return 0;
+}
+
+/*
+ * Take a received character without waiting.
+ *
+ * param uartRecieveData:
+ *          Where to store the character.
+ *
+ * returns:
+ *          0 if a character was stored, -1 if the RX buffer is empty and
+ *          the call would block.
+ */
+int UART_tryRecieve(uartPort *port, unsigned char *uartRecieveData)
+{
+    if(port->rxHead == port->rxTail)
+        return -1;
+
+    *uartRecieveData = port->rxBuffer[port->rxTail & (UART_RX_BUFFER_SIZE - 1)];
+    port->rxTail++;
+
+    /* Bytes may have been left in the hardware FIFO while the buffer was full */
+    if((UART_REG(port, UART_O_FR) & 0x10) == 0)
+        UART_PEND(port); // pend the UART so the handler picks them up
+
+    return 0;
+}
+
+/*
+ * Take everything that has been received, up to max bytes, without waiting.
+ * Much cheaper than a UART_tryRecieve() per byte when working on blocks.
+ *
+ * returns:
+ *          The number of bytes copied into buffer, 0 if nothing is waiting.
+ */
+size_t UART_read(uartPort *port, uint8_t *buffer, size_t max)
+{
+    unsigned int tail = port->rxTail;
+    size_t count = port->rxHead - tail;
+    size_t first;
+
+    if(count > max)
+        count = max;
+    if(count == 0)
+        return 0;
+
+    /* Up to two copies, either side of the wrap */
+    first = UART_RX_BUFFER_SIZE - (tail & (UART_RX_BUFFER_SIZE - 1));
+    if(first > count)
+        first = count;
+    memcpy(buffer, &port->rxBuffer[tail & (UART_RX_BUFFER_SIZE - 1)], first);
+    memcpy(buffer + first, port->rxBuffer, count - first);
+    port->rxTail = tail + count;
+
+    /* Bytes may have been left in the hardware FIFO while the buffer was full */
+    if((UART_REG(port, UART_O_FR) & 0x10) == 0)
+        UART_PEND(port); // pend the UART so the handler picks them up
+
+    return count;
+}
+
+/*
+ * Transmit a whole buffer with uDMA. The data is read straight out of the
+ * buffer, so it must stay untouched until the callback runs. The CPU is only
+ * involved once every UDMA_MAX_TRANSFER bytes. Single character sends are
+ * refused while the transfer is running.
+ *
+ * param buffer:
+ *          The data to send.
+ *
+ * param length:
+ *          The number of bytes in buffer.
+ *
+ * param callback:
+ *          Called from the UART interrupt handler once the last byte is in
+ *          the hardware FIFO. May be NULL.
+ *
+ * returns:
+ *          0 if the transfer was started, -1 if a previous transfer or
+ *          buffered characters are still being sent.
+ */
+int UART_sendBuffer(uartPort *port, const uint8_t *buffer, size_t length, void (*callback)(void))
+{
+    int irq = port->hw->irq;
+
+    if(port->dmaBusy || (port->txHead != port->txTail))
+        return -1;
+
+    if(length == 0) {
+        if(callback)
+            callback();
+        return 0;
+    }
+
+    init_udma();
+    UDMA_assign(port->hw->txDmaChannel, port->hw->txDmaEncoding);
+
+    port->dmaNext = buffer;
+    port->dmaRemaining = length;
+    port->dmaCallback = callback;
+    port->dmaBusy = 1;
+
+    /* The completion interrupt arrives on the UART's own vector */
+    (&NVIC_EN0_R)[irq / 32] = 1UL << (irq % 32);
+
+    UART_startTxChunk(port);
+    UART_REG(port, UART_O_DMACTL) |= 0x02; // p.885, TXDMAE
+
+    return 0;
+}
+
+/* Non-zero while a UART_sendBuffer() transfer is running */
+int UART_sendBufferBusy(uartPort *port)
+{
+    return port->dmaBusy;
+}
+
+/*
+ * Put a port into 9-bit mode for a multidrop (RS-485) bus, p.887. The 9th
+ * bit marks a byte as an address. The receiver compares every address byte
+ * against its own and only lets the address and the data after it into the
+ * RX FIFO when they match, so a node is not interrupted for traffic meant
+ * for other nodes. The matching address byte is the first byte received.
+ *
+ * param address:
+ *          This node's address.
+ *
+ * param mask:
+ *          Which address bits must match. 0xFF for an exact match, or clear
+ *          low bits to also answer a group or broadcast address.
+ */
+void UART_9bitMode(uartPort *port, uint8_t address, uint8_t mask)
+{
+    UART_REG(port, UART_O_CTL) &= ~0x01; // p.868, disable the UART during config
+    UART_REG(port, UART_O_9BITAMASK) = mask; // p.888
+    UART_REG(port, UART_O_9BITADDR) = 0x8000 | address; // p.887, 9BITEN
+
+    /* Stick parity carries the 9th bit. EPS set sends it as 0, for data */
+    UART_REG(port, UART_O_LCRH) |= 0x86; // p.866, SPS, EPS and PEN
+    UART_REG(port, UART_O_CTL) |= 0x01;
+}
 
-    // Configure PB0 and PB1 as UART ports
-    GPIO_PORTB_AFSEL_R |= 0x03; // p.624, enable alternate func for PA0 and PA1
-    GPIO_PORTB_DEN_R |= 0x03; // p.636, enable DEN for PA0 and PA1
-    GPIO_PORTB_PCTL_R = (GPIO_PORTB_PCTL_R & 0xFFFFFF0F) + 0x00000010; //PB1 port control encoding for U1 pg.1135
-    GPIO_PORTB_PCTL_R = (GPIO_PORTB_PCTL_R & 0xFFFFFFF0) + 0x00000001;
-// GPIO_PORTA_DIR is not needed since inputs and outputs for uart pins are predefined in table 14-1
+/*
+ * Send an address byte on a 9-bit bus, selecting the node(s) the data sent
+ * after it is meant for. Blocks until everything queued before it has gone
+ * out, since the 9th bit is set for the whole line, not per byte.
+ */
+void UART_sendAddress(uartPort *port, uint8_t address)
+{
+    while(port->dmaBusy || (port->txHead != port->txTail)); // let queued data finish
+    while((UART_REG(port, UART_O_FR) & 0x88) != 0x80); // p.861, TXFE set and BUSY clear
+
+    UART_REG(port, UART_O_LCRH) &= ~0x04; // EPS clear, 9th bit sent as 1
+    UART_REG(port, UART_O_DR) = address;
+    while((UART_REG(port, UART_O_FR) & 0x88) != 0x80);
+    UART_REG(port, UART_O_LCRH) |= 0x04; // back to data
 }
 
 /* UART send character function */
-void UART1_send(unsigned char uartSendData)
+void UART_send(uartPort *port, unsigned char uartSendData)
 {
-    while((UART1_FR_R & 0x20) != 0); // wait if Transmit FIFO is full, TXFF
-    UART1_DR_R = uartSendData;
+    while(port->dmaBusy); // wait for a UART_sendBuffer() transfer to finish
+
+    if(port->interruptMode) {
+        while(UART_trySend(port, uartSendData) != 0); // wait for room in the TX buffer
+        return;
+    }
+
+    while((UART_REG(port, UART_O_FR) & 0x20) != 0); // wait if Transmit FIFO is full, TXFF
+    UART_REG(port, UART_O_DR) = uartSendData;
 
 }
 
 /* UART receive character function */
+unsigned char UART_recieve(uartPort *port)
+{
+    unsigned char uartRecieveData;
+    unsigned long data;
+
+    if(port->interruptMode) {
+        while(UART_tryRecieve(port, &uartRecieveData) != 0); // wait for a character in the RX buffer
+        return uartRecieveData;
+    }
+
+    while((UART_REG(port, UART_O_FR) & 0x10) != 0);  // wait until receive FIFO is empty, RXFE
+    data = UART_REG(port, UART_O_DR);
+    UART_countErrors(port, data);
+    return((unsigned char)(data & 0xFF)); // return the received character (only 8-bit)
+}
+
+/*
+ * Read the receive error counts of a port. The counts are kept from
+ * UART_init() on, and are only updated as characters are read, either by
+ * the interrupt handler or by UART_recieve().
+ *
+ * param overrun:
+ *          Set to the number of times the RX FIFO overflowed and a byte was
+ *          lost. Stays at zero with RTS/CTS flow control unless the far end
+ *          ignores RTS.
+ *
+ * param framing:
+ *          Set to the number of characters received without a valid stop
+ *          bit, usually a baud rate mismatch or noise on the line.
+ */
+void UART_errorCounts(uartPort *port, unsigned long *overrun, unsigned long *framing)
+{
+    *overrun = port->overrunErrors;
+    *framing = port->framingErrors;
+}
+
+/*
+ * Initialise uart1 on PB0 and PB1.
+ *
+ * param baud:
+ *          The baud rate
+ *
+ * param clk:
+ *          The bus frequency being used in MHz. Enter numbers like, 8, 16, or
+ *          80.
+ */
+void UART1_init(int baud, int clk)
+{
+    UART_init(&uart1, &UART1_PB0_PB1, baud, clk);
+}
+
+void UART1_interrupt(int pri)
+{
+    UART_interrupt(&uart1, pri);
+}
+
+void UART1_send(unsigned char uartSendData)
+{
+    UART_send(&uart1, uartSendData);
+}
+
 unsigned char UART1_recieve(void)
 {
-    while((UART1_FR_R & 0x10) != 0);  // wait until receive FIFO is empty, RXFE
-    return((unsigned char)(UART1_DR_R & 0xFF)); // return the received character (only 8-bit)
+    return UART_recieve(&uart1);
+}
+
+int UART1_trySend(unsigned char uartSendData)
+{
+    return UART_trySend(&uart1, uartSendData);
+}
+
+int UART1_tryRecieve(unsigned char *uartRecieveData)
+{
+    return UART_tryRecieve(&uart1, uartRecieveData);
+}
+
+int UART1_sendBuffer(const uint8_t *buffer, size_t length, void (*callback)(void))
+{
+    return UART_sendBuffer(&uart1, buffer, length, callback);
+}
+
+int UART1_sendBufferBusy(void)
+{
+    return UART_sendBufferBusy(&uart1);
 }
 
 /* Function to convert lower case character to upper case and return */
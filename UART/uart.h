@@ -8,9 +8,160 @@
 #ifndef UART_H_
 #define UART_H_
 
+#include <inttypes.h>
+#include <stddef.h>
+
+/*
+ * Sizes of the software TX and RX buffers each port uses in interrupt mode.
+ * Both must be a power of two so that the indices can be wrapped with a mask.
+ */
+#define UART_TX_BUFFER_SIZE 64
+#define UART_RX_BUFFER_SIZE 64
+
+/*
+ * Baud rate divisor, p.845. The divisor is clk / (div * baud), where div is
+ * 16 normally or 8 with HSE set. IBRD holds the integer part and FBRD the
+ * fraction in 64ths, so the whole divisor in 64ths is rounded from
+ * clk * 128 / div / baud, then halved. Everything is integer so these can
+ * be used in #if and in constant expressions.
+ *
+ * param clkHz:
+ *          The bus frequency in Hz, e.g. 16000000 or 80000000.
+ *
+ * param baud:
+ *          The wanted baud rate.
+ *
+ * param div:
+ *          16, or 8 when HSE is set.
+ */
+#define UART_BRD_X64(clkHz, baud, div) \
+    ((((clkHz) * (128 / (div)) / (baud)) + 1) / 2)
+#define UART_IBRD(clkHz, baud, div) (UART_BRD_X64(clkHz, baud, div) >> 6)
+#define UART_FBRD(clkHz, baud, div) (UART_BRD_X64(clkHz, baud, div) & 0x3F)
+
+/* The baud rate the divisor above really gives, rounded to the nearest Hz */
+#define UART_ACTUAL_BAUD(clkHz, baud, div) \
+    (((clkHz) * (64 / (div)) + UART_BRD_X64(clkHz, baud, div) / 2) / \
+     UART_BRD_X64(clkHz, baud, div))
+
+/*
+ * Signed error of the actual baud rate in parts per million. The cast keeps
+ * it signed when baud is unsigned, e.g. 115200UL, which also means it
+ * cannot go in #if. Use UART_BAUD_ASSERT() for build time checks.
+ */
+#define UART_BAUD_ERROR_PPM(clkHz, baud, div) \
+    ((((long long)UART_ACTUAL_BAUD(clkHz, baud, div) - (long long)(baud)) * 1000000LL) / \
+     (long long)(baud))
+
+/*
+ * Fail the build if a clock/baud pair is off by more than maxPpm, e.g.
+ *
+ *      UART_BAUD_ASSERT(16000000, 115200, 16, 10000);
+ *
+ * The check is named after the line it is on, so any number of them can go
+ * in one file, one per line.
+ */
+#define UART_BAUD_ASSERT(clkHz, baud, div, maxPpm) \
+    typedef char UART_BAUD_CHECK_NAME(__LINE__)[ \
+        (UART_BAUD_ERROR_PPM(clkHz, baud, div) <= (maxPpm) && \
+         UART_BAUD_ERROR_PPM(clkHz, baud, div) >= -(maxPpm)) ? 1 : -1]
+
+/* Two steps, so __LINE__ is expanded before it is pasted */
+#define UART_BAUD_CHECK_NAME(line) UART_BAUD_CHECK_PASTE(line)
+#define UART_BAUD_CHECK_PASTE(line) uartBaudCheck_##line
+
+/*
+ * Everything that differs between one UART and the next: where its registers
+ * are, which interrupt and uDMA channel it has, and which pins it is muxed
+ * onto. One of these exists for every pin option in uart.c, so adding a port
+ * only needs a new uartPort, not new code.
+ */
+typedef struct {
+    int number;              /* 0 to 7, UARTn */
+    unsigned long base;      /* UARTn register block */
+    int irq;                 /* NVIC interrupt number, table 2-9 p.104 */
+    int txDmaChannel;        /* uDMA channel for TX, table 9-1 p.587 */
+    int txDmaEncoding;
+    unsigned long gpioBase;  /* GPIO port register block for the pins */
+    unsigned int gpioClock;  /* bit for the port in RCGC2 */
+    unsigned int gpioPins;   /* RX and TX pin mask */
+    unsigned long pctl;      /* PCTL value for those pins, p.1351 */
+
+    /* RTS/CTS pins. Left zero when the instance has no flow control */
+    unsigned long flowGpioBase;
+    unsigned int flowGpioClock;
+    unsigned int flowPins;
+    unsigned long flowPctl;
+} uartInstance;
+
+extern const uartInstance UART0_PA0_PA1;
+extern const uartInstance UART1_PB0_PB1;
+extern const uartInstance UART1_PC4_PC5;
+extern const uartInstance UART1_PB0_PB1_RTS_PC4_CTS_PC5;
+extern const uartInstance UART2_PD6_PD7;
+extern const uartInstance UART3_PC6_PC7;
+extern const uartInstance UART4_PC4_PC5;
+extern const uartInstance UART5_PE4_PE5;
+extern const uartInstance UART6_PD4_PD5;
+extern const uartInstance UART7_PE0_PE1;
+
+/*
+ * Run time state of one port. Declare one per serial link and hand it to
+ * UART_init(). The fields are private to uart.c.
+ */
+typedef struct {
+    const uartInstance *hw;
+    int interruptMode;
+
+    /*
+     * Single-producer/single-consumer ring buffers used in interrupt mode.
+     * The indices run freely and are masked on access.
+     */
+    unsigned char txBuffer[UART_TX_BUFFER_SIZE];
+    volatile unsigned int txHead;
+    volatile unsigned int txTail;
+    unsigned char rxBuffer[UART_RX_BUFFER_SIZE];
+    volatile unsigned int rxHead;
+    volatile unsigned int rxTail;
+
+    /* uDMA arbitration size that fits the TX FIFO at its trigger level */
+    uint32_t txDmaArb;
+
+    /* Receive errors seen so far, see UART_errorCounts() */
+    volatile unsigned long overrunErrors;
+    volatile unsigned long framingErrors;
+
+    /* State of the transfer started by UART_sendBuffer() */
+    const uint8_t *dmaNext;
+    volatile size_t dmaRemaining;
+    volatile int dmaBusy;
+    void (*dmaCallback)(void);
+} uartPort;
+
+void UART_init(uartPort *, const uartInstance *, int, int);
+void UART_initHighSpeed(uartPort *, const uartInstance *, int, int);
+void UART_fifoLevels(uartPort *, int, int);
+void UART_interrupt(uartPort *, int);
+void UART_send(uartPort *, unsigned char);
+unsigned char UART_recieve(uartPort *);
+int UART_trySend(uartPort *, unsigned char);
+int UART_tryRecieve(uartPort *, unsigned char *);
+size_t UART_read(uartPort *, uint8_t *, size_t);
+int UART_sendBuffer(uartPort *, const uint8_t *, size_t, void (*)(void));
+int UART_sendBufferBusy(uartPort *);
+void UART_errorCounts(uartPort *, unsigned long *, unsigned long *);
+void UART_9bitMode(uartPort *, uint8_t, uint8_t);
+void UART_sendAddress(uartPort *, uint8_t);
+
+/* UART1 on PB0/PB1, kept for existing code */
 void UART1_init(int, int);
+void UART1_interrupt(int);
 void UART1_send(unsigned char);
 unsigned char UART1_recieve(void);
+int UART1_trySend(unsigned char);
+int UART1_tryRecieve(unsigned char *);
+int UART1_sendBuffer(const uint8_t *, size_t, void (*)(void));
+int UART1_sendBufferBusy(void);
 unsigned char ToUpperCase(unsigned char);
 
 #endif /* UART_H_ */
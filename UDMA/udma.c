@@ -0,0 +1,147 @@
+#include "tm4c123gh6pm.h"
+#include <inttypes.h>
+#include <stdlib.h>
+
+/*
+ * One entry of the channel control table, p.608. The addresses point at the
+ * LAST item of the source and destination, not the first.
+ */
+typedef struct {
+    volatile uint32_t srcEnd;
+    volatile uint32_t dstEnd;
+    volatile uint32_t control;
+    uint32_t unused;
+} udmaControl;
+
+/*
+ * Primary control structures for channels 0-31 followed by the alternate
+ * ones, which are only needed for ping-pong transfers. The table must be
+ * aligned on a 1024 byte boundary, p.600.
+ */
+#if defined(__TI_COMPILER_VERSION__)
+#pragma DATA_ALIGN(udmaControlTable, 1024)
+static udmaControl udmaControlTable[64];
+#else
+static udmaControl udmaControlTable[64] __attribute__((aligned(1024)));
+#endif
+
+/*
+ * Enable the uDMA controller and point it at the channel control table.
+ * Safe to call more than once, so every peripheral that uses uDMA can call
+ * it from its own init.
+ */
+void init_udma(void) {
+
+    volatile unsigned long delay_clk;
+
+    SYSCTL_RCGCDMA_R |= 0x01; //p.342 - enable clock for uDMA
+    delay_clk = SYSCTL_RCGCDMA_R; //dummy operation for clock to settle
+
+    UDMA_CFG_R = 0x01; //p.617 - master enable
+    UDMA_CTLBASE_R = (uint32_t)(uintptr_t)udmaControlTable; //p.618
+}
+
+/*
+ * Select which peripheral drives a channel, p.640
+ *
+ * param channel:
+ *          The uDMA channel, 0 to 31
+ *
+ * param encoding:
+ *          The channel encoding, 0 to 4. See table 9-1 on p.587 of the
+ *          data sheet.
+ */
+void UDMA_assign(int channel, int encoding) {
+
+    volatile unsigned long *chmap;
+    int shift;
+
+    if(channel < 0 || channel > 31 || encoding < 0 || encoding > 4)
+        exit(EXIT_FAILURE);
+
+    chmap = &UDMA_CHMAP0_R + (channel / 8);
+    shift = (channel % 8) * 4;
+    *chmap = (*chmap & ~(0xFUL << shift)) | ((unsigned long)encoding << shift);
+
+    UDMA_ALTCLR_R = 1UL << channel; //p.632 - start on the primary structure
+    UDMA_USEBURSTCLR_R = 1UL << channel; //p.625 - respond to single and burst requests
+    UDMA_REQMASKCLR_R = 1UL << channel; //p.627 - let the peripheral make requests
+}
+
+/*
+ * Fill in a control structure for a channel. The channel is not enabled.
+ *
+ * param channel:
+ *          The uDMA channel, 0 to 31
+ *
+ * param alt:
+ *          0 for the primary control structure, 1 for the alternate.
+ *
+ * param src, dst:
+ *          The first item of the source and destination. The end pointers
+ *          the controller wants are worked out from the increments and the
+ *          transfer size in control.
+ *
+ * param control:
+ *          The channel control word, p.611. Build it from the UDMA_CHCTL_
+ *          fields in tm4c123gh6pm.h. XFERSIZE holds the item count minus one.
+ */
+void UDMA_setTransfer(int channel, int alt, const volatile void *src, volatile void *dst, uint32_t control) {
+
+    udmaControl *entry = &udmaControlTable[channel + (alt ? 32 : 0)];
+    uint32_t last = (control & UDMA_CHCTL_XFERSIZE_M) >> UDMA_CHCTL_XFERSIZE_S;
+    uint32_t srcInc = (control & UDMA_CHCTL_SRCINC_M) >> 26;
+    uint32_t dstInc = (control & UDMA_CHCTL_DSTINC_M) >> 30;
+
+    /* An increment field of 3 means no increment */
+    entry->srcEnd = (uint32_t)(uintptr_t)src + ((srcInc == 3) ? 0 : (last << srcInc));
+    entry->dstEnd = (uint32_t)(uintptr_t)dst + ((dstInc == 3) ? 0 : (last << dstInc));
+    entry->control = control;
+}
+
+/*
+ * Arm a channel. The peripheral requests do the rest.
+ */
+void UDMA_enable(int channel) {
+
+    UDMA_ENASET_R = 1UL << channel; //p.629
+}
+
+/*
+ * Stop a channel, abandoning whatever is left of its transfer.
+ */
+void UDMA_disable(int channel) {
+
+    UDMA_ENACLR_R = 1UL << channel; //p.630
+}
+
+/*
+ * The controller clears the enable bit itself when a basic transfer finishes.
+ */
+int UDMA_isEnabled(int channel) {
+
+    return (UDMA_ENASET_R >> channel) & 0x01;
+}
+
+/*
+ * Check and clear the completion flag of a channel, p.642. Meant for the
+ * interrupt handler of the peripheral that owns the channel.
+ */
+int UDMA_isDone(int channel) {
+
+    if(UDMA_CHIS_R & (1UL << channel)) {
+        UDMA_CHIS_R = 1UL << channel;
+        return 1;
+    }
+    return 0;
+}
+
+/*
+ * The transfer mode field of a control structure. The controller sets it to
+ * stop (0) when the structure is used up, which is how a ping-pong handler
+ * tells which half finished.
+ */
+uint32_t UDMA_getMode(int channel, int alt) {
+
+    return udmaControlTable[channel + (alt ? 32 : 0)].control & UDMA_CHCTL_XFERMODE_M;
+}
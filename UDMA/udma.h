@@ -0,0 +1,28 @@
+#include <inttypes.h>
+/*
+ * udma.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: bjh885
+ *
+ * Micro Direct Memory Access controller. Holds the channel control table and
+ * the routines to set up a channel. Peripherals that use uDMA get their
+ * completion interrupt on their own vector and check UDMA_CHIS_R there.
+ */
+
+#ifndef UDMA_H_
+#define UDMA_H_
+
+/* The most items a single uDMA transfer can move, p.611 */
+#define UDMA_MAX_TRANSFER 1024
+
+void init_udma(void);
+void UDMA_assign(int, int);
+void UDMA_setTransfer(int, int, const volatile void *, volatile void *, uint32_t);
+void UDMA_enable(int);
+void UDMA_disable(int);
+int UDMA_isEnabled(int);
+int UDMA_isDone(int);
+uint32_t UDMA_getMode(int, int);
+
+#endif /* UDMA_H_ */
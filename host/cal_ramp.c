@@ -0,0 +1,108 @@
+/*
+ * cal_ramp.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: bjh885
+ *
+ * Runs the linearity calibration against a simulated ADC. The model has a
+ * gain and offset error, a bow of 3 LSB across the range and half an LSB or
+ * so of noise. A slow ramp from below zero to past full scale builds the
+ * code histogram, CAL_correctionsFromInl() turns the INL into corrections,
+ * then the same ramp is run again through CAL_apply(). The INL has to get
+ * smaller, and CAL_enob() of the corrected ramp has to agree with the same
+ * fit done in double precision.
+ *
+ *      gcc -I. -DCAL_HOST -o cal_ramp host/cal_ramp.c ADC/calibration.c -lm && ./cal_ramp
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ADC/calibration.h"
+
+#define TEST_CHANNEL 5
+#define TEST_STEPS 44000                /* 0.1 LSB each from -200 */
+
+/* Samples off each end of the ramp, where it is clipped */
+#define TEST_CLIP 2500
+
+static uint32_t histogram[4096];
+static int16_t inl[4096];
+static uint16_t ramp[TEST_STEPS];
+
+static uint16_t SIM_adc(double v) {
+
+    double x = v * 0.98 + 12 + 3 * sin(M_PI * v / 4096) + ((rand() % 1000) / 1000.0 - 0.5) * 0.8;
+    long code = lround(x);
+
+    return code < 0 ? 0 : (code > 4095 ? 4095 : (uint16_t)code);
+}
+
+/* The same fit as CAL_enob(), in double */
+static double REF_enob(const uint16_t *samples, int n) {
+
+    double sx = 0, sy = 0, sxx = 0, sxy = 0, slope, offset, error = 0, e;
+    int i;
+
+    for(i = 0; i < n; i++) {
+        sx += i;
+        sy += samples[i];
+        sxx += (double)i * i;
+        sxy += (double)i * samples[i];
+    }
+    slope = (n * sxy - sx * sy) / (n * sxx - sx * sx);
+    offset = (sy - slope * sx) / n;
+
+    for(i = 0; i < n; i++) {
+        e = samples[i] - (offset + slope * i);
+        error += e * e;
+    }
+
+    return 12 - log2(sqrt(error / n) * sqrt(12));
+}
+
+static void TEST_print(const char *name, const calLinearity *summary) {
+
+    printf("%-7s DNL %6.3f .. %6.3f  INL %6.3f .. %6.3f  missing %d\n", name,
+           summary->minDnl / 1000.0, summary->maxDnl / 1000.0,
+           summary->minInl / 1000.0, summary->maxInl / 1000.0, summary->missingCodes);
+}
+
+int main(void) {
+
+    calLinearity before, after;
+    int32_t enob;
+    double reference;
+    int failed = 0;
+    int i;
+
+    srand(25);
+    CAL_init();
+
+    for(i = 0; i < TEST_STEPS; i++)
+        histogram[SIM_adc(-200 + i / 10.0)]++;
+    CAL_linearity(histogram, 0, inl, &before);
+    TEST_print("before", &before);
+
+    CAL_correctionsFromInl(TEST_CHANNEL, inl);
+    memset(histogram, 0, sizeof(histogram));
+    for(i = 0; i < TEST_STEPS; i++) {
+        ramp[i] = CAL_apply(TEST_CHANNEL, SIM_adc(-200 + i / 10.0));
+        histogram[ramp[i]]++;
+    }
+    CAL_linearity(histogram, 0, inl, &after);
+    TEST_print("after", &after);
+
+    enob = CAL_enob(ramp + TEST_CLIP, TEST_STEPS - 2 * TEST_CLIP);
+    reference = REF_enob(ramp + TEST_CLIP, TEST_STEPS - 2 * TEST_CLIP);
+    printf("ENOB %ld.%02ld bits, double fit %.3f\n", (long)enob / 100, (long)enob % 100, reference);
+
+    if(after.maxInl - after.minInl >= before.maxInl - before.minInl)
+        failed = 1;
+    if(fabs(enob / 100.0 - reference) > 0.01 || enob < 1000)
+        failed = 1;
+
+    printf(failed ? "FAIL\n" : "PASS\n");
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,134 @@
+/*
+ * cic_enob.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: bjh885
+ *
+ * Effective resolution of the oversampling chain against a simulated noisy
+ * ADC. The model quantises a slow ramp plus 1.5 LSB RMS of gaussian noise to
+ * 12 bits. ADC_oversample() is modelled as the ADCSAC averager does it: the
+ * sum of factor conversions shifted back down to 12 bits. Each setting runs
+ * the stream through CIC_block() and CAL_enob() measures the result, scaled
+ * to the width of the output. Each doubling of the total averaging should
+ * buy about half a bit, so 1024x and up has to reach 14 bits.
+ *
+ *      gcc -I. -DCAL_HOST -o cic_enob host/cic_enob.c ADC/cic.c ADC/calibration.c -lm && ./cic_enob
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "ADC/cic.h"
+#include "ADC/calibration.h"
+
+#define TEST_OUTPUTS 4096               /* results measured per setting */
+#define TEST_NOISE 1.5                  /* LSB RMS before any averaging */
+#define TEST_LOW 300.0                  /* ramp start and end, in LSB */
+#define TEST_HIGH 3800.0
+
+/* FIFO entries for the highest CIC ratio */
+#define TEST_RAW (TEST_OUTPUTS * 64)
+
+typedef struct {
+    const char *name;
+    int sac;                /* ADC_oversample() factor */
+    int order;              /* 0 for no CIC */
+    int ratio;
+    int outBits;
+    int32_t minimum;        /* ENOB to pass, hundredths of a bit */
+} testSetting;
+
+static const testSetting settings[] = {
+    {"raw 12 bit",                1,  0,  0,  0,    0},
+    {"ADCSAC 16x",               16,  0,  0,  0, 1100},
+    {"CIC order 1, 16x",          1,  1, 16, 16, 1100},
+    {"CIC order 2, 64x",          1,  2, 64, 16, 1250},
+    {"ADCSAC 16x + CIC 2, 16x",  16,  2, 16, 16, 1300},
+    {"ADCSAC 64x + CIC 2, 16x",  64,  2, 16, 16, 1400},
+    {"ADCSAC 64x + CIC 2, 64x",  64,  2, 64, 16, 1450},
+};
+
+static uint16_t stream[TEST_RAW];
+static uint32_t out[TEST_OUTPUTS + 1];
+static uint16_t results[TEST_OUTPUTS];
+
+static double SIM_gauss(void) {
+
+    double u = (rand() + 1.0) / (RAND_MAX + 2.0);
+    double v = (rand() + 1.0) / (RAND_MAX + 2.0);
+
+    return sqrt(-2 * log(u)) * cos(2 * M_PI * v);
+}
+
+/* One conversion of the ADC, as ADC_readFifo() would return it */
+static uint16_t SIM_convert(double v) {
+
+    long code = lround(v + TEST_NOISE * SIM_gauss());
+
+    return code < 0 ? 0 : (code > 4095 ? 4095 : (uint16_t)code);
+}
+
+/* One FIFO entry with the hardware averager at factor */
+static uint16_t SIM_sample(double v, int factor) {
+
+    uint32_t sum = 0;
+    int shift = 0;
+    int i;
+
+    for(i = 0; i < factor; i++)
+        sum += SIM_convert(v);
+    while((1 << shift) < factor)
+        shift++;
+
+    return (uint16_t)(sum >> shift);
+}
+
+/*
+ * Run one setting over the whole ramp.
+ *
+ * returns the ENOB in hundredths of a bit.
+ */
+static int32_t TEST_setting(const testSetting *setting) {
+
+    cicFilter cic;
+    int ratio = setting->order ? setting->ratio : 1;
+    int raw = TEST_OUTPUTS * ratio;
+    int skip = setting->order; //outputs before the combs are full
+    int produced, i, k;
+
+    for(i = 0; i < raw; i++)
+        stream[i] = SIM_sample(TEST_LOW + (TEST_HIGH - TEST_LOW) * i / raw, setting->sac);
+
+    if(!setting->order)
+        return CAL_enob(stream, raw);
+
+    CIC_init(&cic, setting->order, setting->ratio, setting->outBits);
+    produced = 0;
+    for(i = 0; i < raw; i += 256) //in acquisition sized blocks
+        produced += CIC_block(&cic, stream + i, (raw - i < 256) ? raw - i : 256, out + produced);
+
+    for(k = 0; k + skip < produced; k++)
+        results[k] = (uint16_t)out[k + skip];
+
+    /* An ideal N bit converter leaves 1/sqrt(12) of its own LSB */
+    return CAL_enob(results, k) + 100 * (setting->outBits - 12);
+}
+
+int main(void) {
+
+    int32_t enob;
+    int failed = 0;
+    unsigned i;
+
+    srand(16);
+    printf("%-26s ENOB\n", "setting");
+    for(i = 0; i < sizeof(settings) / sizeof(settings[0]); i++) {
+        enob = TEST_setting(&settings[i]);
+        printf("%-26s %2ld.%02ld\n", settings[i].name, (long)enob / 100, (long)enob % 100);
+        if(enob < settings[i].minimum)
+            failed = 1;
+    }
+
+    printf(failed ? "FAIL\n" : "PASS\n");
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,145 @@
+/*
+ * codec_test.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: bjh885
+ *
+ * Round trips a noisy 12 bit sine through DSP/codec.c. Delta coding has to
+ * give back every sample exactly. ADPCM goes through an adpcmHistory ring
+ * small enough to wrap several times, and what it reads back has to be the
+ * newest blocks, in order, within the error bounds below. Compression is
+ * against 2 bytes per sample in a uint16_t.
+ *
+ *      gcc -I. -o codec_test host/codec_test.c DSP/codec.c -lm && ./codec_test
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "DSP/codec.h"
+
+#define TEST_BLOCK 256                  /* samples per block, as acquisition delivers them */
+#define TEST_BLOCKS 40
+#define TEST_LENGTH (TEST_BLOCK * TEST_BLOCKS)
+#define TEST_SLOTS 12                   /* blocks the ring holds */
+
+#define TEST_MAX_RMS 2.0                /* ADPCM error bounds, in counts */
+#define TEST_MAX_ERROR 16
+
+static uint16_t signal[TEST_LENGTH];
+static uint16_t decoded[TEST_LENGTH];
+static uint8_t encoded[DELTA_MAX_SIZE(TEST_LENGTH)];
+
+/* Two tones and 8 counts of noise, slow enough that most deltas fit a byte */
+static void TEST_signal(void) {
+
+    int i;
+
+    for(i = 0; i < TEST_LENGTH; i++)
+        signal[i] = (uint16_t)(2048 + lround(1200 * sin(2 * M_PI * i / 1500.0) +
+                                             300 * sin(2 * M_PI * i / 170.0)) + rand() % 9 - 4);
+}
+
+static int TEST_delta(void) {
+
+    size_t bytes = DELTA_encode(signal, TEST_LENGTH, encoded);
+    int n = DELTA_decode(encoded, bytes, decoded, TEST_LENGTH);
+    int i;
+
+    if(n != TEST_LENGTH) {
+        printf("delta decoded %d of %d samples\n", n, TEST_LENGTH);
+        return 1;
+    }
+    for(i = 0; i < TEST_LENGTH; i++) {
+        if(decoded[i] != signal[i]) {
+            printf("delta sample %d is %u, sent %u\n", i, decoded[i], signal[i]);
+            return 1;
+        }
+    }
+
+    /* One sample too many for the room given must be refused */
+    if(DELTA_decode(encoded, bytes, decoded, TEST_LENGTH - 1) != -1) {
+        printf("delta overran its output\n");
+        return 1;
+    }
+
+    printf("delta  %5.2fx, exact\n", 2.0 * TEST_LENGTH / bytes);
+    return 0;
+}
+
+/*
+ * Error of n decoded samples against the signal from first on.
+ *
+ * returns 1 if either bound is broken.
+ */
+static int TEST_adpcmError(const char *name, int first, int n, double ratio) {
+
+    double sum = 0, rms;
+    int worst = 0;
+    int error, i;
+
+    for(i = 0; i < n; i++) {
+        error = abs((int)decoded[i] - signal[first + i]);
+        sum += (double)error * error;
+        if(error > worst)
+            worst = error;
+    }
+    rms = sqrt(sum / n);
+
+    printf("%-6s %5.2fx, %d samples, RMS error %.2f, worst %d\n", name, ratio, n, rms, worst);
+    return (rms > TEST_MAX_RMS || worst > TEST_MAX_ERROR) ? 1 : 0;
+}
+
+static int TEST_adpcm(void) {
+
+    static uint8_t storage[TEST_SLOTS * ADPCM_BLOCK_SIZE(TEST_BLOCK)];
+    static uint8_t block[ADPCM_BLOCK_SIZE(TEST_BLOCK)];
+    adpcmHistory history;
+    adpcmState state;
+    double ratio = 2.0 * TEST_BLOCK / ADPCM_BLOCK_SIZE(TEST_BLOCK);
+    int failed = 0;
+    int i, n;
+
+    ADPCM_historyInit(&history, storage, sizeof(storage), TEST_BLOCK);
+    for(i = 0; i < TEST_BLOCKS; i++)
+        ADPCM_historyAdd(&history, signal + i * TEST_BLOCK);
+
+    /* The ring has wrapped, so only the newest TEST_SLOTS blocks are left */
+    n = ADPCM_historyRead(&history, decoded, TEST_LENGTH);
+    if(n != TEST_SLOTS * TEST_BLOCK) {
+        printf("history gave %d samples, expected %d\n", n, TEST_SLOTS * TEST_BLOCK);
+        return 1;
+    }
+    failed |= TEST_adpcmError("ADPCM", TEST_LENGTH - n, n, ratio);
+
+    /* Less room than the ring holds still gives the newest blocks */
+    n = ADPCM_historyRead(&history, decoded, 3 * TEST_BLOCK + 10);
+    if(n != 3 * TEST_BLOCK) {
+        printf("history gave %d samples, expected %d\n", n, 3 * TEST_BLOCK);
+        return 1;
+    }
+    failed |= TEST_adpcmError("newest", TEST_LENGTH - n, n, ratio);
+
+    /* A block from the middle of the stream decodes on its own */
+    ADPCM_init(&state);
+    for(i = 0; i <= TEST_BLOCKS / 2; i++)
+        ADPCM_encode(&state, signal + i * TEST_BLOCK, TEST_BLOCK, block);
+    ADPCM_decode(block, TEST_BLOCK, decoded);
+    failed |= TEST_adpcmError("alone", (TEST_BLOCKS / 2) * TEST_BLOCK, TEST_BLOCK, ratio);
+
+    return failed;
+}
+
+int main(void) {
+
+    int failed = 0;
+
+    srand(23);
+    TEST_signal();
+
+    failed |= TEST_delta();
+    failed |= TEST_adpcm();
+
+    printf(failed ? "FAIL\n" : "PASS\n");
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,155 @@
+/*
+ * fft_test.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: bjh885
+ *
+ * Checks FFT_q15() at every size against a DFT done in double precision on
+ * the same Q15 input, scaled by 1/n as FFT_q15() is. Every bin must be
+ * within 8 LSB, counting the real and imaginary errors together. Also
+ * checks FFT_magnitude() and the goertzel detector.
+ *
+ *      gcc -I. -o fft_test host/fft_test.c DSP/fft.c -lm && ./fft_test
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "DSP/fft.h"
+
+#define TEST_MAX_ERROR 8.0
+
+static uint16_t adc[FFT_MAX_SIZE];
+static int16_t data[2 * FFT_MAX_SIZE];
+static double input[2 * FFT_MAX_SIZE];
+static double dft[2 * FFT_MAX_SIZE];
+
+static void REF_dft(int n) {
+
+    double re, im, w;
+    int k, t;
+
+    for(k = 0; k < n; k++) {
+        re = 0;
+        im = 0;
+        for(t = 0; t < n; t++) {
+            w = 2 * M_PI * (double)((long)k * t % n) / n;
+            re += input[2 * t] * cos(w) + input[2 * t + 1] * sin(w);
+            im += input[2 * t + 1] * cos(w) - input[2 * t] * sin(w);
+        }
+        dft[2 * k] = re / n;
+        dft[2 * k + 1] = im / n;
+    }
+}
+
+/*
+ * Transform the ADC block in adc[] both ways.
+ *
+ * returns the largest error in LSB, |re error| + |im error|.
+ */
+static double TEST_block(int n) {
+
+    double error, worst = 0;
+    int i;
+
+    FFT_fromAdc(adc, data, n);
+    for(i = 0; i < 2 * n; i++)
+        input[i] = data[i];
+
+    FFT_q15(data, n);
+    REF_dft(n);
+
+    for(i = 0; i < n; i++) {
+        error = fabs(data[2 * i] - dft[2 * i]) + fabs(data[2 * i + 1] - dft[2 * i + 1]);
+        if(error > worst)
+            worst = error;
+    }
+
+    return worst;
+}
+
+static int TEST_fft(void) {
+
+    double tones, noise;
+    int failed = 0;
+    int n, i;
+
+    printf("   n  two tones  full scale noise\n");
+    for(n = FFT_MIN_SIZE; n <= FFT_MAX_SIZE; n *= 2) {
+        for(i = 0; i < n; i++)
+            adc[i] = (uint16_t)(2048 + lround(1500 * cos(2 * M_PI * 5 * i / n) +
+                                              400 * sin(2 * M_PI * (n / 8) * i / n)));
+        tones = TEST_block(n);
+
+        for(i = 0; i < n; i++)
+            adc[i] = rand() % 4096;
+        noise = TEST_block(n);
+
+        printf("%4d  %9.1f  %16.1f\n", n, tones, noise);
+        if(tones >= TEST_MAX_ERROR || noise >= TEST_MAX_ERROR)
+            failed = 1;
+    }
+
+    return failed;
+}
+
+/* The alpha max plus beta min estimate is within 7% of the true magnitude */
+static int TEST_magnitude(void) {
+
+    uint16_t magnitude[FFT_MAX_SIZE / 2];
+    double exact;
+    int i;
+
+    for(i = 0; i < 2 * FFT_MAX_SIZE; i++)
+        data[i] = (int16_t)(rand() % 65536 - 32768) / 2;
+    FFT_magnitude(data, magnitude, FFT_MAX_SIZE);
+
+    for(i = 0; i < FFT_MAX_SIZE / 2; i++) {
+        exact = hypot(data[2 * i], data[2 * i + 1]);
+        if(fabs(magnitude[i] - exact) > 0.07 * exact + 1) {
+            printf("FFT_magnitude bin %d is %u, exact %.1f\n", i, magnitude[i], exact);
+            return 1;
+        }
+    }
+    printf("FFT_magnitude within 7%%\n");
+
+    return 0;
+}
+
+/*
+ * A 697 Hz DTMF row tone at 8 kHz. Its own detector should see amplitude
+ * 1000 squared, the 1209 Hz column detector next to nothing.
+ */
+static int TEST_goertzel(void) {
+
+    goertzel on, off;
+    uint32_t onPower, offPower;
+    int i;
+
+    for(i = 0; i < 205; i++)
+        adc[i] = (uint16_t)(2048 + lround(1000 * sin(2 * M_PI * 697 * i / 8000.0)));
+
+    GOERTZEL_init(&on, 697, 8000, 205);
+    GOERTZEL_init(&off, 1209, 8000, 205);
+    if(GOERTZEL_block(&on, adc, 205, &onPower) != 1 || GOERTZEL_block(&off, adc, 205, &offPower) != 1) {
+        printf("goertzel gave no result\n");
+        return 1;
+    }
+    printf("goertzel 697 Hz power %lu, 1209 Hz power %lu\n",
+           (unsigned long)onPower, (unsigned long)offPower);
+
+    return (onPower < 960000 || onPower > 1040000 || offPower > 10000) ? 1 : 0;
+}
+
+int main(void) {
+
+    int failed = 0;
+
+    srand(18);
+    failed |= TEST_fft();
+    failed |= TEST_magnitude();
+    failed |= TEST_goertzel();
+
+    printf(failed ? "FAIL\n" : "PASS\n");
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,300 @@
+/*
+ * filter_test.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: bjh885
+ *
+ * Checks DSP/filter.c against plain loop reference filters. The references
+ * keep the whole input history in an array and evaluate each output straight
+ * from the difference equation, one multiply at a time, with none of the
+ * state mirroring or paired multiplies of the real code. Both sides round
+ * the same way, so every output has to match exactly. Random inputs are fed
+ * in random block sizes so state carried between calls is covered too.
+ *
+ *      gcc -I. -o filter_test host/filter_test.c DSP/filter.c && ./filter_test
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "DSP/filter.h"
+
+#define TEST_LENGTH 4000
+
+static int16_t input16[TEST_LENGTH];
+static int32_t input32[TEST_LENGTH];
+
+static int16_t ref16[TEST_LENGTH];
+static int32_t ref32[TEST_LENGTH];
+
+static int16_t saturate16(int64_t x) {
+
+    return x > 32767 ? 32767 : (x < -32768 ? -32768 : (int16_t)x);
+}
+
+static int32_t saturate32(int64_t x) {
+
+    return x > INT32_MAX ? INT32_MAX : (x < INT32_MIN ? INT32_MIN : (int32_t)x);
+}
+
+static void REF_firQ15(const int16_t *h, int taps, const int16_t *x, int16_t *y, int n) {
+
+    int64_t acc;
+    int i, k;
+
+    for(i = 0; i < n; i++) {
+        acc = 0;
+        for(k = 0; k < taps && k <= i; k++)
+            acc += (int64_t)h[k] * x[i - k];
+        y[i] = saturate16(acc >> 15);
+    }
+}
+
+static void REF_firQ31(const int32_t *h, int taps, const int32_t *x, int32_t *y, int n) {
+
+    int64_t acc;
+    int i, k;
+
+    for(i = 0; i < n; i++) {
+        acc = 0;
+        for(k = 0; k < taps && k <= i; k++)
+            acc += (int64_t)h[k] * x[i - k];
+        y[i] = saturate32(acc >> 31);
+    }
+}
+
+/* One stage at a time over the whole signal, out of place */
+static void REF_biquadQ15(const int16_t *c, int stages, int postShift, const int16_t *x, int16_t *y, int n) {
+
+    static int16_t stageIn[TEST_LENGTH];
+    int64_t acc;
+    int stage, i;
+
+    memcpy(stageIn, x, n * sizeof(int16_t));
+    for(stage = 0; stage < stages; stage++, c += 5) {
+        for(i = 0; i < n; i++) {
+            acc = (int64_t)c[0] * stageIn[i];
+            if(i >= 1)
+                acc += (int64_t)c[1] * stageIn[i - 1] + (int64_t)c[3] * y[i - 1];
+            if(i >= 2)
+                acc += (int64_t)c[2] * stageIn[i - 2] + (int64_t)c[4] * y[i - 2];
+            y[i] = saturate16(acc >> (15 - postShift));
+        }
+        memcpy(stageIn, y, n * sizeof(int16_t));
+    }
+}
+
+static void REF_biquadQ31(const int32_t *c, int stages, int postShift, const int32_t *x, int32_t *y, int n) {
+
+    static int32_t stageIn[TEST_LENGTH];
+    int64_t acc;
+    int stage, i;
+
+    memcpy(stageIn, x, n * sizeof(int32_t));
+    for(stage = 0; stage < stages; stage++, c += 5) {
+        for(i = 0; i < n; i++) {
+            acc = (int64_t)c[0] * stageIn[i];
+            if(i >= 1)
+                acc += (int64_t)c[1] * stageIn[i - 1] + (int64_t)c[3] * y[i - 1];
+            if(i >= 2)
+                acc += (int64_t)c[2] * stageIn[i - 2] + (int64_t)c[4] * y[i - 2];
+            y[i] = saturate32(acc >> (31 - postShift));
+        }
+        memcpy(stageIn, y, n * sizeof(int32_t));
+    }
+}
+
+static void REF_movingAverage(int length, const int16_t *x, int16_t *y, int n) {
+
+    int32_t sum;
+    int i, k;
+
+    for(i = 0; i < n; i++) {
+        sum = 0;
+        for(k = 0; k < length && k <= i; k++)
+            sum += x[i - k];
+        y[i] = (int16_t)(sum / length);
+    }
+}
+
+/* Random block sizes from 1 to 64, the last one cut to fit */
+static int TEST_block(int done) {
+
+    int n = 1 + rand() % 64;
+
+    return (done + n > TEST_LENGTH) ? TEST_LENGTH - done : n;
+}
+
+static int TEST_compare16(const char *name, const int16_t *out, const int16_t *ref) {
+
+    int i;
+
+    for(i = 0; i < TEST_LENGTH; i++) {
+        if(out[i] != ref[i]) {
+            printf("%-24s output %d is %d, reference %d\n", name, i, out[i], ref[i]);
+            return -1;
+        }
+    }
+    printf("%-24s %d outputs match\n", name, TEST_LENGTH);
+    return 0;
+}
+
+static int TEST_compare32(const char *name, const int32_t *out, const int32_t *ref) {
+
+    int i;
+
+    for(i = 0; i < TEST_LENGTH; i++) {
+        if(out[i] != ref[i]) {
+            printf("%-24s output %d is %ld, reference %ld\n", name, i, (long)out[i], (long)ref[i]);
+            return -1;
+        }
+    }
+    printf("%-24s %d outputs match\n", name, TEST_LENGTH);
+    return 0;
+}
+
+static int TEST_firQ15(int taps) {
+
+    static int16_t h[64], state[128], out[TEST_LENGTH];
+    char name[32];
+    firQ15 fir;
+    int i, n;
+
+    for(i = 0; i < taps; i++)
+        h[i] = (int16_t)(rand() % 65536 - 32768) / 4;
+
+    FILTER_initFirQ15(&fir, h, state, taps);
+    for(i = 0; i < TEST_LENGTH; i += n) {
+        n = TEST_block(i);
+        FILTER_firQ15(&fir, input16 + i, out + i, n);
+    }
+    REF_firQ15(h, taps, input16, ref16, TEST_LENGTH);
+
+    sprintf(name, "FIR Q15, %d taps", taps);
+    return TEST_compare16(name, out, ref16);
+}
+
+static int TEST_firQ31(int taps) {
+
+    static int32_t h[64], state[128], out[TEST_LENGTH];
+    char name[32];
+    firQ31 fir;
+    int i, n;
+
+    for(i = 0; i < taps; i++)
+        h[i] = (int32_t)((uint32_t)rand() << 16 ^ (uint32_t)rand()) / 4;
+
+    FILTER_initFirQ31(&fir, h, state, taps);
+    for(i = 0; i < TEST_LENGTH; i += n) {
+        n = TEST_block(i);
+        FILTER_firQ31(&fir, input32 + i, out + i, n);
+    }
+    REF_firQ31(h, taps, input32, ref32, TEST_LENGTH);
+
+    sprintf(name, "FIR Q31, %d taps", taps);
+    return TEST_compare32(name, out, ref32);
+}
+
+/*
+ * Two low pass sections, about fc = fs/20 and Q 0.7, in Q14 with
+ * postShift 1 so b and a fit.
+ */
+static const int16_t biquad16[10] = {
+    345, 690, 345, 26956, -11953,
+    345, 690, 345, 26956, -11953,
+};
+
+static const int32_t biquad32[10] = {
+    22608532, 45217064, 22608532, 1766585728, -783317024,
+    22608532, 45217064, 22608532, 1766585728, -783317024,
+};
+
+static int TEST_biquad(void) {
+
+    static int16_t state16[8], out16[TEST_LENGTH];
+    static int32_t state32[8], out32[TEST_LENGTH];
+    biquadQ15 bq16;
+    biquadQ31 bq32;
+    int failed = 0;
+    int i, n;
+
+    FILTER_initBiquadQ15(&bq16, biquad16, state16, 2, 1);
+    for(i = 0; i < TEST_LENGTH; i += n) {
+        n = TEST_block(i);
+        FILTER_biquadQ15(&bq16, input16 + i, out16 + i, n);
+    }
+    REF_biquadQ15(biquad16, 2, 1, input16, ref16, TEST_LENGTH);
+    failed |= TEST_compare16("biquad Q15, 2 stages", out16, ref16);
+
+    FILTER_initBiquadQ31(&bq32, biquad32, state32, 2, 1);
+    for(i = 0; i < TEST_LENGTH; i += n) {
+        n = TEST_block(i);
+        FILTER_biquadQ31(&bq32, input32 + i, out32 + i, n);
+    }
+    REF_biquadQ31(biquad32, 2, 1, input32, ref32, TEST_LENGTH);
+    failed |= TEST_compare32("biquad Q31, 2 stages", out32, ref32);
+
+    return failed;
+}
+
+static int TEST_movingAverage(int length) {
+
+    static int16_t history[64], out[TEST_LENGTH];
+    char name[32];
+    movingAverage ma;
+    int i, n;
+
+    FILTER_initMovingAverage(&ma, history, length);
+    for(i = 0; i < TEST_LENGTH; i += n) {
+        n = TEST_block(i);
+        FILTER_movingAverage(&ma, input16 + i, out + i, n);
+    }
+    REF_movingAverage(length, input16, ref16, TEST_LENGTH);
+
+    sprintf(name, "moving average, %d", length);
+    return TEST_compare16(name, out, ref16);
+}
+
+/* The SWAR conversion against the obvious one */
+static int TEST_fromAdc(void) {
+
+    static uint16_t adc[TEST_LENGTH];
+    static int16_t out[TEST_LENGTH];
+    int i;
+
+    for(i = 0; i < TEST_LENGTH; i++) {
+        adc[i] = rand() % 4096;
+        ref16[i] = (int16_t)((adc[i] - 2048) * 16);
+    }
+    FILTER_fromAdc(adc, out, TEST_LENGTH - 1); //odd count, covers the tail
+    out[TEST_LENGTH - 1] = ref16[TEST_LENGTH - 1];
+
+    return TEST_compare16("FILTER_fromAdc", out, ref16);
+}
+
+int main(void) {
+
+    int failed = 0;
+    int i;
+
+    srand(17);
+    for(i = 0; i < TEST_LENGTH; i++) {
+        /* A slow full scale sweep with noise, so saturation is reached */
+        input16[i] = (int16_t)((i % 400) * 160 - 32000 + rand() % 2001 - 1000);
+        input32[i] = ((int32_t)input16[i] << 16) ^ (rand() & 0xFFFF);
+    }
+
+    failed |= TEST_fromAdc();
+    failed |= TEST_firQ15(1);
+    failed |= TEST_firQ15(31);
+    failed |= TEST_firQ15(64);
+    failed |= TEST_firQ31(1);
+    failed |= TEST_firQ31(32);
+    failed |= TEST_biquad();
+    failed |= TEST_movingAverage(1);
+    failed |= TEST_movingAverage(16);
+    failed |= TEST_movingAverage(50);
+
+    printf(failed ? "FAIL\n" : "PASS\n");
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,59 @@
+/*
+ * frame_decode.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: bjh885
+ *
+ * Decode a raw capture of framed UART traffic (see UART/frame.h) and print
+ * every good frame as its sequence number and payload in hex. Damaged and
+ * missing frames are counted at the end.
+ *
+ *      gcc -I. -DFRAME_HOST -o frame_decode host/frame_decode.c UART/frame.c
+ *      ./frame_decode capture.bin
+ *
+ * Reads stdin when no file is given.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "UART/frame.h"
+
+int main(int argc, char **argv)
+{
+    FILE *in = stdin;
+    frameRx rx;
+    const uint8_t *payload;
+    unsigned long frames = 0;
+    int c, length, i;
+
+    if(argc > 2) {
+        fprintf(stderr, "usage: %s [capture]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if(argc == 2 && (in = fopen(argv[1], "rb")) == NULL) {
+        perror(argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    FRAME_rxInit(&rx);
+    while((c = getc(in)) != EOF) {
+        length = FRAME_receiveByte(&rx, (uint8_t)c);
+        if(length <= 0)
+            continue;
+
+        payload = FRAME_payload(&rx);
+        printf("%3u %3d:", FRAME_sequence(&rx), length);
+        for(i = 0; i < length; i++)
+            printf(" %02x", payload[i]);
+        putchar('\n');
+        frames++;
+    }
+
+    if(in != stdin)
+        fclose(in);
+
+    fprintf(stderr, "%lu frames, %lu damaged, %lu missing\n",
+            frames, rx.badFrames, rx.lostFrames);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,89 @@
+/*
+ * frame_rate.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: bjh885
+ *
+ * Payload throughput of the framing in UART/frame.h against the raw line
+ * rate. Frames of ADC samples, two bytes each, are encoded with
+ * FRAME_encode() and decoded again, and the bytes on the line are counted.
+ * 8N1 puts baud / 10 bytes a second on the line, so the payload rate is
+ * that times payload / line bytes. The same samples printed as ASCII
+ * decimal lines are shown for comparison. Every frame has to decode to what
+ * was sent and fit in FRAME_ENCODED_SIZE(). The cycles the target takes to
+ * encode come from BENCH_frame() in DSP/bench.c.
+ *
+ *      gcc -I. -DFRAME_HOST -o frame_rate host/frame_rate.c UART/frame.c && ./frame_rate
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "UART/frame.h"
+
+#define TEST_FRAMES 1000                /* frames sent per payload size */
+
+static const int sizes[] = {16, 64, 128, 250};
+static const long bauds[] = {115200, 921600};
+
+int main(void)
+{
+    static uint8_t payload[FRAME_MAX_PAYLOAD];
+    static uint8_t line[FRAME_ENCODED_SIZE(FRAME_MAX_PAYLOAD)];
+    char ascii[8];
+    frameRx rx;
+    unsigned long payloadBytes, lineBytes, asciiBytes;
+    size_t encoded;
+    int failed = 0;
+    int s, f, i, b, length;
+    uint16_t sample;
+
+    srand(7);
+    printf("payload  line bytes  efficiency");
+    for(b = 0; b < 2; b++)
+        printf("  %7ld baud", bauds[b]);
+    printf("  ASCII/line\n");
+
+    for(s = 0; s < 4; s++) {
+        payloadBytes = 0;
+        lineBytes = 0;
+        asciiBytes = 0;
+        FRAME_rxInit(&rx);
+
+        for(f = 0; f < TEST_FRAMES; f++) {
+            /* A noisy 12 bit signal, little endian, so zero bytes turn up */
+            for(i = 0; i < sizes[s]; i += 2) {
+                sample = (uint16_t)(2048 + (f * 37 + i * 11) % 1500 + rand() % 64);
+                payload[i] = (uint8_t)(sample & 0xFF);
+                payload[i + 1] = (uint8_t)(sample >> 8);
+                asciiBytes += sprintf(ascii, "%u\r\n", sample);
+            }
+
+            encoded = FRAME_encode((uint8_t)f, payload, sizes[s], line);
+            if(encoded == 0 || encoded > FRAME_ENCODED_SIZE(sizes[s]))
+                failed = 1;
+
+            length = 0;
+            for(i = 0; i < (int)encoded; i++)
+                length = FRAME_receiveByte(&rx, line[i]);
+            if(length != sizes[s] || memcmp(FRAME_payload(&rx), payload, sizes[s]) != 0) {
+                printf("frame %d of %d bytes did not decode\n", f, sizes[s]);
+                failed = 1;
+            }
+
+            payloadBytes += sizes[s];
+            lineBytes += encoded;
+        }
+        if(rx.lostFrames || rx.badFrames)
+            failed = 1;
+
+        printf("%7d  %10.1f  %9.1f%%", sizes[s], (double)lineBytes / TEST_FRAMES,
+               100.0 * payloadBytes / lineBytes);
+        for(b = 0; b < 2; b++)
+            printf("  %7.0f B/s", bauds[b] / 10.0 * payloadBytes / lineBytes);
+        printf("  %9.2fx\n", (double)asciiBytes / lineBytes);
+    }
+
+    printf(failed ? "FAIL\n" : "PASS\n");
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
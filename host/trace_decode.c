@@ -0,0 +1,54 @@
+/*
+ * trace_decode.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: bjh885
+ *
+ * Turn a raw capture of TRACE_flush() output back into text, one line per
+ * record, using the formats in UART/trace_events.h. Frames lost on the way
+ * are reported in line so gaps in the trace are visible.
+ *
+ *      gcc -I. -DTRACE_HOST -DFRAME_HOST -o trace_decode host/trace_decode.c UART/trace.c UART/frame.c
+ *      ./trace_decode capture.bin
+ *
+ * Reads stdin when no file is given.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "UART/trace.h"
+
+int main(int argc, char **argv)
+{
+    FILE *in = stdin;
+    frameRx rx;
+    unsigned long lost = 0;
+    int c, length;
+
+    if(argc > 2) {
+        fprintf(stderr, "usage: %s [capture]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if(argc == 2 && (in = fopen(argv[1], "rb")) == NULL) {
+        perror(argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    FRAME_rxInit(&rx);
+    while((c = getc(in)) != EOF) {
+        length = FRAME_receiveByte(&rx, (uint8_t)c);
+        if(length <= 0)
+            continue;
+
+        if(rx.lostFrames != lost) {
+            printf("trace: %lu frames missing\n", rx.lostFrames - lost);
+            lost = rx.lostFrames;
+        }
+        TRACE_decode(FRAME_payload(&rx), length, stdout);
+    }
+
+    if(in != stdin)
+        fclose(in);
+
+    return EXIT_SUCCESS;
+}
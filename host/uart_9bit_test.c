@@ -0,0 +1,135 @@
+/*
+ * uart_9bit_test.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: bjh885
+ *
+ * Several nodes share one simulated RS-485 bus. Each is set up with
+ * UART_9bitMode() and the bus carries random frames, each an address byte
+ * followed by data. The test counts how often each node is interrupted,
+ * checks it receives exactly the frames its address and mask select, and
+ * compares against the same traffic with 9-bit mode off.
+ *
+ *      gcc -I. -o uart_9bit_test host/uart_9bit_test.c UDMA/udma.c && ./uart_9bit_test
+ */
+
+#include "uart_sim.h"
+
+#define TEST_FRAMES 2000
+#define TEST_NODES 5
+
+/* Character times between frames, enough for the receive time-out */
+#define TEST_GAP 6
+
+static const struct {
+    uint8_t address;
+    uint8_t mask;
+} nodes[TEST_NODES] = {
+    {0x10, 0xFF},
+    {0x11, 0xFF},
+    {0x12, 0xFF},
+    {0x14, 0xFC},   /* answers 0x14 to 0x17 */
+    {0x20, 0xFF},   /* never addressed */
+};
+
+/* Addresses that appear on the bus. 0x30 is nobody's */
+static const uint8_t traffic[] = {0x10, 0x11, 0x12, 0x15, 0x16, 0x30};
+
+/*
+ * Send the same frames to every node, draining each node's ring buffer after
+ * every frame, and total up the interrupts.
+ *
+ * returns:
+ *          0 if every node received exactly what was addressed to it.
+ */
+static int TEST_bus(int nineBit, unsigned long interrupts[TEST_NODES])
+{
+    uartPort ports[TEST_NODES];
+    simUart *sims[TEST_NODES];
+    unsigned long expected[TEST_NODES] = {0}, received[TEST_NODES] = {0};
+    uint8_t block[UART_RX_BUFFER_SIZE];
+    uint8_t address;
+    int frame, length, i, node, failed = 0;
+    size_t count, k;
+
+    srand(1);
+    simCount = 0;
+    simLast = 0;
+    for(node = 0; node < TEST_NODES; node++) {
+        sims[node] = SIM_add(&ports[node], 4);
+        if(nineBit)
+            UART_9bitMode(&ports[node], nodes[node].address, nodes[node].mask);
+    }
+
+    for(frame = 0; frame < TEST_FRAMES; frame++) {
+        address = traffic[rand() % sizeof(traffic)];
+        length = 1 + rand() % 24;
+
+        for(node = 0; node < TEST_NODES; node++) {
+            if(!nineBit || ((address ^ nodes[node].address) & nodes[node].mask) == 0)
+                expected[node] += 1 + length;
+        }
+
+        for(i = -1; i < length + TEST_GAP; i++) {
+            for(node = 0; node < TEST_NODES; node++) {
+                if(i < 0)
+                    SIM_receive(sims[node], address, 1);
+                else if(i < length)
+                    SIM_receive(sims[node], (frame + i) & 0xFF, 0);
+                else
+                    SIM_idle(sims[node]);
+                SIM_service(sims[node]);
+            }
+        }
+
+        for(node = 0; node < TEST_NODES; node++) {
+            while((count = UART_read(&ports[node], block, sizeof(block))) != 0) {
+                SIM_service(sims[node]);
+                received[node] += count;
+                for(k = 0; k < count; k++) {
+                    if(nineBit && k == 0 && block[0] != address) {
+                        printf("node 0x%02x got 0x%02x instead of address 0x%02x\n",
+                               nodes[node].address, block[0], address);
+                        failed = 1;
+                    }
+                }
+            }
+        }
+    }
+
+    for(node = 0; node < TEST_NODES; node++) {
+        interrupts[node] = sims[node]->interrupts;
+        if(received[node] != expected[node] || sims[node]->overruns) {
+            printf("node 0x%02x received %lu bytes, expected %lu\n",
+                   nodes[node].address, received[node], expected[node]);
+            failed = 1;
+        }
+    }
+
+    return failed ? -1 : 0;
+}
+
+int main(void)
+{
+    unsigned long filtered[TEST_NODES], unfiltered[TEST_NODES];
+    int failed = 0, node;
+
+    failed |= TEST_bus(1, filtered);
+    failed |= TEST_bus(0, unfiltered);
+
+    printf("%d frames on the bus\n", TEST_FRAMES);
+    printf("node  mask  interrupts  without 9-bit mode\n");
+    for(node = 0; node < TEST_NODES; node++) {
+        printf("0x%02x  0x%02x  %10lu  %18lu\n", nodes[node].address, nodes[node].mask,
+               filtered[node], unfiltered[node]);
+        if(filtered[node] >= unfiltered[node])
+            failed = 1;
+    }
+
+    /* A node nobody addresses must never wake */
+    if(filtered[TEST_NODES - 1] != 0)
+        failed = 1;
+
+    printf(failed ? "FAIL\n" : "PASS\n");
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
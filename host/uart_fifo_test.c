@@ -0,0 +1,117 @@
+/*
+ * uart_fifo_test.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: bjh885
+ *
+ * Streams bytes into the interrupt-driven receive path of UART/uart.c at
+ * full line rate through the simulated FIFO in uart_sim.h, and checks that
+ * every byte comes out of the ring buffer once and in order.
+ *
+ *      gcc -I. -o uart_fifo_test host/uart_fifo_test.c UDMA/udma.c && ./uart_fifo_test
+ */
+
+#include "uart_sim.h"
+
+#define TEST_BYTES 100000
+
+/* Give up if nothing is delivered for this many character times */
+#define TEST_STALL 1000
+
+/*
+ * Send TEST_BYTES back to back, one per character time, and read them out
+ * of the ring buffer in bursts.
+ *
+ * param flow:
+ *          Hold the sender off with RTS, as UART1_PB0_PB1_RTS_PC4_CTS_PC5
+ *          would.
+ *
+ * param period, stall:
+ *          The consumer reads once every period character times, and stops
+ *          reading for stall character times out of every 50 periods.
+ *
+ * returns:
+ *          0 if every byte arrived in order, -1 otherwise.
+ */
+static int TEST_stream(const char *name, int flow, int rxLevel, int period, int stall)
+{
+    uartPort port;
+    simUart *sim;
+    uint8_t block[UART_RX_BUFFER_SIZE];
+    unsigned char byte;
+    unsigned long sent = 0, received = 0, time = 0, lastProgress = 0;
+    unsigned long overrun, framing;
+    size_t count, i;
+
+    simCount = 0;
+    simLast = 0;
+    sim = SIM_add(&port, rxLevel);
+
+    while(received < TEST_BYTES) {
+        if(sent < TEST_BYTES && (!flow || SIM_rts(sim))) {
+            SIM_receive(sim, sent & 0xFF, 0);
+            sent++;
+        }
+        else {
+            SIM_idle(sim);
+        }
+        SIM_service(sim);
+        time++;
+
+        if((time % period) == 0 && (time % (50UL * period)) >= (unsigned long)stall) {
+            /* Mix block reads with single bytes, both pend the handler */
+            if(time & 1) {
+                count = UART_read(&port, block, sizeof(block));
+            }
+            else {
+                count = 0;
+                while(count < sizeof(block) && UART_tryRecieve(&port, &byte) == 0)
+                    block[count++] = byte;
+            }
+            SIM_service(sim);
+
+            for(i = 0; i < count; i++) {
+                if(block[i] != (received & 0xFF)) {
+                    printf("%-28s byte %lu is 0x%02x, expected 0x%02lx\n",
+                           name, received, block[i], received & 0xFF);
+                    return -1;
+                }
+                received++;
+            }
+            if(count)
+                lastProgress = time;
+        }
+
+        if(time - lastProgress > TEST_STALL) {
+            printf("%-28s stuck after %lu of %d bytes, %d left in the FIFO\n",
+                   name, received, TEST_BYTES, sim->fifoCount);
+            return -1;
+        }
+    }
+
+    UART_errorCounts(&port, &overrun, &framing);
+    printf("%-28s %6lu bytes in %6lu char times, %5lu interrupts, %lu overruns\n",
+           name, received, time, sim->interrupts, overrun);
+
+    return (overrun || sim->overruns) ? -1 : 0;
+}
+
+int main(void)
+{
+    int failed = 0;
+
+    /* The consumer keeps up on average, bursts are absorbed by the ring */
+    failed |= TEST_stream("line rate, RX level 1/2", 0, 4, 16, 0);
+    failed |= TEST_stream("line rate, RX level 7/8", 0, 7, 32, 0);
+
+    /*
+     * The consumer stalls long enough to fill the ring. The bytes left in
+     * the FIFO are only collected by the handler pended from UART_read()
+     * and UART_tryRecieve(), with RTS holding the sender off meanwhile.
+     */
+    failed |= TEST_stream("RTS/CTS, consumer stalls", 1, 4, 16, 300);
+    failed |= TEST_stream("RTS/CTS, slow consumer", 1, 2, 200, 0);
+
+    printf(failed ? "FAIL\n" : "PASS\n");
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
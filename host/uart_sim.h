@@ -0,0 +1,237 @@
+/*
+ * uart_sim.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: bjh885
+ *
+ * A simulated UART for host tests of UART/uart.c. The driver is compiled
+ * straight into the test with UART_HOST defined, so its statics, including
+ * UART_handler(), are visible and every register access lands here.
+ *
+ * Only the receive side is modelled, p.854:
+ *      - a 16 entry RX FIFO, with overrun (OE in RSR, OERIS) when a byte
+ *        arrives while it is full
+ *      - RXRIS set on the edge where the FIFO fills past the IFLS trigger
+ *        level, and cleared by ICR or by reading it back below the level
+ *      - RTRIS set once the FIFO has held data for 32 bit periods (rounded
+ *        to 4 character times) without a new byte, cleared by ICR or by
+ *        emptying the FIFO
+ *      - RTS deasserted while the FIFO is at the trigger level or above
+ *      - 9-bit address matching against 9BITADDR/9BITAMASK, p.887
+ * Register writes are applied on the next access, which is always before
+ * anything could observe them on the real part. DR is only ever read.
+ */
+
+#ifndef UART_SIM_H_
+#define UART_SIM_H_
+
+#define UART_HOST
+#include "UART/uart.c"
+
+#include <stdio.h>
+
+#define SIM_MAX_UARTS 8
+
+typedef struct {
+    unsigned long base;
+    uartInstance hw;
+    uartPort *port;
+
+    unsigned int fifo[16];
+    int fifoHead;
+    int fifoCount;
+
+    unsigned long ris;
+    unsigned long icr;
+    unsigned long rsr;
+    unsigned long scratch;
+    unsigned long regs[0x100 / 4];  /* everything else up to 9BITAMASK */
+
+    int idle;           /* character times since the last byte arrived */
+    int timeoutArmed;
+    int pended;         /* set by UART_PEND() */
+    int matched;        /* 9-bit mode, the last address was ours */
+
+    unsigned long interrupts;   /* UART_handler() calls */
+    unsigned long overruns;     /* bytes the FIFO had no room for */
+} simUart;
+
+static simUart simUarts[SIM_MAX_UARTS];
+static int simCount;
+static simUart *simLast;
+
+/* Apply a write to ICR left by the last register access */
+static inline void SIM_commit(void)
+{
+    if(simLast && simLast->icr) {
+        simLast->ris &= ~simLast->icr;
+        simLast->icr = 0;
+    }
+}
+
+static inline simUart *SIM_find(unsigned long base)
+{
+    int i;
+
+    for(i = 0; i < simCount; i++) {
+        if(simUarts[i].base == base)
+            return &simUarts[i];
+    }
+    fprintf(stderr, "no simulated UART at 0x%lx\n", base);
+    exit(EXIT_FAILURE);
+}
+
+/* The RX trigger level in bytes, from IFLS, p.869 */
+static inline int SIM_rxLevel(simUart *sim)
+{
+    static const int levels[8] = {2, 4, 8, 12, 14, 16, 16, 16};
+
+    return levels[(sim->regs[UART_O_IFLS / 4] >> 3) & 0x7];
+}
+
+volatile unsigned long *UART_hostRegister(unsigned long base, unsigned long offset)
+{
+    simUart *sim;
+
+    SIM_commit();
+    sim = SIM_find(base);
+    simLast = sim;
+
+    switch(offset) {
+    case UART_O_DR:
+        sim->scratch = 0;
+        if(sim->fifoCount) {
+            sim->scratch = sim->fifo[sim->fifoHead];
+            sim->fifoHead = (sim->fifoHead + 1) & 15;
+            sim->fifoCount--;
+            if(sim->fifoCount < SIM_rxLevel(sim))
+                sim->ris &= ~0x10;
+            if(sim->fifoCount == 0)
+                sim->ris &= ~0x40;
+        }
+        return &sim->scratch;
+    case UART_O_RSR:
+        return &sim->rsr; // ECR, any write clears it
+    case UART_O_FR:
+        sim->scratch = 0x80 | (sim->fifoCount ? 0 : 0x10); // TXFE, RXFE
+        return &sim->scratch;
+    case UART_O_MIS:
+        sim->scratch = sim->ris & sim->regs[UART_O_IM / 4];
+        return &sim->scratch;
+    case UART_O_ICR:
+        return &sim->icr;
+    default:
+        if(offset >= sizeof(sim->regs)) {
+            fprintf(stderr, "unexpected UART register 0x%lx\n", offset);
+            exit(EXIT_FAILURE);
+        }
+        return &sim->regs[offset / 4];
+    }
+}
+
+void UART_hostPend(int irq)
+{
+    int i;
+
+    for(i = 0; i < simCount; i++) {
+        if(simUarts[i].hw.irq == irq)
+            simUarts[i].pended = 1;
+    }
+}
+
+/*
+ * Add a simulated UART and put port on it in interrupt mode, the way
+ * UART_interrupt() leaves it, with the given RX trigger level in eighths.
+ */
+static inline simUart *SIM_add(uartPort *port, int rxLevel)
+{
+    simUart *sim = &simUarts[simCount];
+
+    memset(sim, 0, sizeof(*sim));
+    sim->base = 0x4000C000 + 0x1000 * simCount;
+    sim->hw.number = simCount;
+    sim->hw.base = sim->base;
+    sim->hw.irq = 5 + simCount;
+    sim->port = port;
+    sim->regs[UART_O_IFLS / 4] = 0x12; // reset value, p.869
+    simCount++;
+
+    memset(port, 0, sizeof(*port));
+    port->hw = &sim->hw;
+    UART_fifoLevels(port, rxLevel, 4);
+    UART_REG(port, UART_O_IM) = 0x470;
+    port->interruptMode = 1;
+    SIM_commit();
+
+    return sim;
+}
+
+/* Non-zero while RTS tells the far end it may send */
+static inline int SIM_rts(simUart *sim)
+{
+    return sim->fifoCount < SIM_rxLevel(sim);
+}
+
+/*
+ * One character arrives off the line. address marks the 9th bit on a
+ * multidrop bus.
+ */
+static inline void SIM_receive(simUart *sim, unsigned int data, int address)
+{
+    unsigned long addr = sim->regs[UART_O_9BITADDR / 4];
+    unsigned long mask = sim->regs[UART_O_9BITAMASK / 4];
+
+    if(addr & 0x8000) { // 9BITEN
+        if(address)
+            sim->matched = ((data ^ addr) & mask & 0xFF) == 0;
+        if(!sim->matched)
+            return;
+    }
+
+    sim->idle = 0;
+    sim->timeoutArmed = 1;
+
+    if(sim->fifoCount == 16) {
+        sim->rsr |= 0x08;
+        sim->ris |= 0x400;
+        sim->overruns++;
+        return;
+    }
+
+    sim->fifo[(sim->fifoHead + sim->fifoCount) & 15] = data & 0xFF;
+    sim->fifoCount++;
+    if(sim->fifoCount == SIM_rxLevel(sim))
+        sim->ris |= 0x10;
+}
+
+/* One character time where nothing arrives */
+static inline void SIM_idle(simUart *sim)
+{
+    if(sim->timeoutArmed && sim->fifoCount && ++sim->idle >= 4) {
+        sim->ris |= 0x40;
+        sim->timeoutArmed = 0;
+    }
+}
+
+/*
+ * Run the handler for as long as the interrupt is pending, as the NVIC
+ * would. Bails out if it never clears.
+ */
+static inline void SIM_service(simUart *sim)
+{
+    int guard = 0;
+
+    SIM_commit();
+    while((sim->ris & sim->regs[UART_O_IM / 4]) || sim->pended) {
+        sim->pended = 0;
+        UART_handler(sim->port);
+        SIM_commit();
+        sim->interrupts++;
+        if(++guard > 100) {
+            fprintf(stderr, "UART%d interrupt stuck pending\n", sim->hw.number);
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+#endif /* UART_SIM_H_ */